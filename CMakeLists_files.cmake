@@ -65,6 +65,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/blackoil/blackoildiffusionmodule.hh
              opm/models/blackoil/blackoilextensivequantities.hh
              opm/models/blackoil/blackoilintensivequantities.hh
+             opm/models/blackoil/blackoilintensivequantitiessoa.hh
              opm/models/blackoil/blackoildarcyfluxmodule.hh
              opm/models/blackoil/blackoilratevector.hh
              opm/models/blackoil/blackoilbrinemodules.hh
@@ -137,6 +138,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbaseproblem.hh
              opm/models/discretization/common/fvbaseprimaryvariables.hh
              opm/models/discretization/common/linearizationtype.hh
+             opm/models/discretization/common/stencilcache.hh
              opm/models/discretization/ecfv/ecfvgridcommhandlefactory.hh
              opm/models/discretization/ecfv/ecfvstencil.hh
              opm/models/discretization/ecfv/ecfvbaseoutputmodule.hh
@@ -165,6 +167,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/io/vtkscalarfunction.hh
              opm/models/io/vtkenergymodule.hh
              opm/models/io/restart.hh
+             opm/models/io/binaryrestart.hh
              opm/models/io/cubegridvanguard.hh
              opm/models/io/baseoutputwriter.hh
              opm/models/io/vtkmultiwriter.hh
@@ -231,6 +234,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/utils/propertysystemmacros.hh
              opm/models/utils/pffgridvector.hh
              opm/models/utils/prefetch.hh
+             opm/models/utils/profiler.hh
              opm/models/utils/parametersystem.hh
              opm/models/utils/simulator.hh
              opm/models/utils/quadraturegeometries.hh
@@ -246,6 +250,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/linalgproperties.hh
              opm/simulators/linalg/linearsolverreport.hh
              opm/simulators/linalg/istlsparsematrixadapter.hh
+             opm/simulators/linalg/csrsparsitypattern.hh
              opm/simulators/linalg/istlpreconditionerwrappers.hh
              opm/simulators/linalg/residreductioncriterion.hh
              opm/simulators/linalg/overlappingbcrsmatrix.hh
@@ -261,6 +266,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/globalindices.hh
              opm/simulators/linalg/superlubackend.hh
              opm/simulators/linalg/matrixblock.hh
+             opm/simulators/linalg/mixedprecisionpreconditioner.hh
              opm/simulators/linalg/istlsolverwrappers.hh
              opm/simulators/linalg/overlaptypes.hh
              opm/simulators/linalg/overlappingpreconditioner.hh
@@ -12,7 +12,8 @@ usage() {
     echo "Usage:"
     echo
     echo "runTest.sh TEST_TYPE -e binary -- [TEST_ARGS]"
-    echo "where TEST_TYPE can either be --plain, --simulation, --spe1 or --parallel-simulation=\$NUM_CORES (is '$TEST_TYPE')."
+    echo "where TEST_TYPE can either be --plain, --simulation, --spe1, --parallel-simulation=\$NUM_CORES"
+    echo "or --parallel-incremental=\$NUM_CORES (is '$TEST_TYPE')."
 };
 
 # this function clips the help message printed by an ewoms simulation
@@ -157,6 +158,42 @@ case "$TEST_TYPE" in
         exit 0
         ;;
 
+    "--parallel-incremental="*)
+        NUM_PROCS="${TEST_TYPE/--parallel-incremental=/}"
+
+        # run the simulation in parallel with the cached intensive quantities
+        # recomputed after every Newton update and with the ones updated
+        # incrementally. the results of both runs must be identical.
+        for INCREMENTAL in false true; do
+            OUT_DIR="incremental-$INCREMENTAL-$RND"
+            mkdir -p "$OUT_DIR"
+            RUN_ARGS="$TEST_ARGS --output-dir=$OUT_DIR --enable-intensive-quantity-cache=true --enable-incremental-intensive-quantities=$INCREMENTAL"
+
+            echo "executing \"mpirun -np \"$NUM_PROCS\" $TEST_BINARY $RUN_ARGS\""
+            mpirun -np "$NUM_PROCS" "$TEST_BINARY" $RUN_ARGS | tee "test-$RND.log"
+            RET="${PIPESTATUS[0]}"
+            rm "test-$RND.log"
+            if test "$RET" != "0"; then
+                echo "Executing the binary failed!"
+                rm -rf "incremental-false-$RND" "incremental-true-$RND"
+                exit 1
+            fi
+        done
+
+        echo "######################"
+        echo "# Comparing results"
+        echo "######################"
+        NUM_FILES=$(ls -- "incremental-false-$RND" | wc -l)
+        if test "$NUM_FILES" = "0" || ! diff -r "incremental-false-$RND" "incremental-true-$RND"; then
+            echo "The results of the incremental and of the full update of the intensive quantities differ"
+            rm -rf "incremental-false-$RND" "incremental-true-$RND"
+            exit 1
+        fi
+
+        rm -rf "incremental-false-$RND" "incremental-true-$RND"
+        exit 0
+        ;;
+
     "--spe1")
         echo "Running the ebos simulator for SPE1CASE1"
 
@@ -274,6 +274,33 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the brine flux over a face for the TPFA linearizer.
+     *
+     * The water volume flux is given per face area. If the upstream cell of the water
+     * phase is not the interior one, its quantities do not contribute to the
+     * derivatives. With LhsEval being Scalar, only the values are computed.
+     */
+    template <class LhsEval>
+    static void computeFlux([[maybe_unused]] Dune::FieldVector<LhsEval, numEq>& flux,
+                            [[maybe_unused]] const LhsEval& waterVolumeFlux,
+                            [[maybe_unused]] const IntensiveQuantities& up,
+                            [[maybe_unused]] bool upIsInterior)
+    {
+        if constexpr (enableBrine) {
+            if (upIsInterior)
+                flux[contiBrineEqIdx] =
+                        waterVolumeFlux
+                        *decay<LhsEval>(up.fluidState().invB(waterPhaseIdx))
+                        *decay<LhsEval>(up.fluidState().saltConcentration());
+            else
+                flux[contiBrineEqIdx] =
+                        waterVolumeFlux
+                        *decay<Scalar>(up.fluidState().invB(waterPhaseIdx))
+                        *decay<Scalar>(up.fluidState().saltConcentration());
+        }
+    }
+
     /*!
      * \brief Return how much a Newton-Raphson update is considered an error
      */
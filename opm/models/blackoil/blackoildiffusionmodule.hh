@@ -74,6 +74,17 @@ public:
                                  unsigned,
                                  unsigned)
     {}
+
+    /*!
+     * \brief Adds the diffusive mass flux to the flux vector over a face for the TPFA
+     *        linearizer.
+     */
+    template <class IntensiveQuantities>
+    static void addDiffusiveFlux(RateVector&,
+                                 const IntensiveQuantities&,
+                                 const IntensiveQuantities&,
+                                 Scalar)
+    {}
 };
 
 /*!
@@ -116,6 +127,52 @@ public:
         const auto& extQuants = context.extensiveQuantities(spaceIdx, timeIdx);
         const auto& fluidStateI = context.intensiveQuantities(extQuants.interiorIndex(), timeIdx).fluidState();
         const auto& fluidStateJ = context.intensiveQuantities(extQuants.exteriorIndex(), timeIdx).fluidState();
+        addDiffusiveFlux_(flux,
+                          fluidStateI,
+                          fluidStateJ,
+                          extQuants.diffusivity(),
+                          [&extQuants](unsigned phaseIdx, unsigned compIdx) -> const Evaluation&
+                          { return extQuants.effectiveDiffusionCoefficient(phaseIdx, compIdx); });
+    }
+
+    /*!
+     * \brief Adds the mass flux due to molecular diffusion to the flux vector over a
+     *        face for the TPFA linearizer.
+     *
+     * The diffusivity must be divided by the area of the face. Only the quantities of
+     * the interior cell carry derivatives.
+     */
+    template <class IntensiveQuantities>
+    static void addDiffusiveFlux(RateVector& flux,
+                                 const IntensiveQuantities& intQuantsIn,
+                                 const IntensiveQuantities& intQuantsEx,
+                                 Scalar diffusivity)
+    {
+        // Only work if diffusion is enabled run-time by DIFFUSE in the deck
+        if(!FluidSystem::enableDiffusion())
+            return;
+
+        // use the arithmetic average for the effective diffusion coefficients
+        addDiffusiveFlux_(flux,
+                          intQuantsIn.fluidState(),
+                          intQuantsEx.fluidState(),
+                          diffusivity,
+                          [&intQuantsIn, &intQuantsEx](unsigned phaseIdx, unsigned compIdx) -> Evaluation
+                          {
+                              return (intQuantsIn.effectiveDiffusionCoefficient(phaseIdx, compIdx)
+                                      + Toolbox::value(intQuantsEx.effectiveDiffusionCoefficient(phaseIdx, compIdx)))
+                                  / 2;
+                          });
+    }
+
+private:
+    template <class FluidState, class EffectiveDiffusionCoefficient>
+    static void addDiffusiveFlux_(RateVector& flux,
+                                  const FluidState& fluidStateI,
+                                  const FluidState& fluidStateJ,
+                                  Scalar diffusivity,
+                                  const EffectiveDiffusionCoefficient& effectiveDiffusionCoefficient)
+    {
         unsigned pvtRegionIndex = fluidStateI.pvtRegionIndex();
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!FluidSystem::phaseIsActive(phaseIdx)) {
@@ -165,8 +222,8 @@ public:
                     - bSAvg
                     * convFactor
                     * diffR
-                    * extQuants.diffusivity()
-                    * extQuants.effectiveDiffusionCoefficient(phaseIdx, solventCompIdx);
+                    * diffusivity
+                    * effectiveDiffusionCoefficient(phaseIdx, solventCompIdx);
             // mass flux of solute component (gas in oil or oil in gas)
             unsigned soluteCompIdx = FluidSystem::soluteComponentIndex(phaseIdx);
             unsigned activeSoluteCompIdx = Indices::canonicalToActiveComponentIndex(soluteCompIdx);
@@ -174,12 +231,11 @@ public:
                     bSAvg
                     * diffR
                     * convFactor
-                    * extQuants.diffusivity()
-                    * extQuants.effectiveDiffusionCoefficient(phaseIdx, soluteCompIdx);
+                    * diffusivity
+                    * effectiveDiffusionCoefficient(phaseIdx, soluteCompIdx);
         }
     }
 
-private:
     static Scalar toMolFractionGasOil (unsigned regionIdx) {
         Scalar mMOil = FluidSystem::molarMass(FluidSystem::oilCompIdx, regionIdx);
         Scalar rhoO = FluidSystem::referenceDensity(FluidSystem::oilPhaseIdx, regionIdx);
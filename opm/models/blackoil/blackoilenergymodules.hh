@@ -38,6 +38,7 @@
 
 #include <dune/common/fvector.hh>
 
+#include <array>
 #include <string>
 
 namespace Opm {
@@ -217,6 +218,115 @@ public:
             flux[contiEnergyEqIdx] += hRate;
     }
 
+    /*!
+     * \brief Compute the energy flux over a face for the TPFA linearizer.
+     *
+     * The volume fluxes of the phases are given per face area. The thermal half
+     * transmissibilities are taken from the parameters of the face. If the upstream
+     * cell of a phase is not the interior one, its quantities do not contribute to the
+     * derivatives.
+     */
+    template <class ResidualNBInfo>
+    static void computeFlux([[maybe_unused]] RateVector& flux,
+                            [[maybe_unused]] const std::array<Evaluation, numPhases>& volumeFlux,
+                            [[maybe_unused]] const std::array<bool, numPhases>& upIsInterior,
+                            [[maybe_unused]] const IntensiveQuantities& intQuantsIn,
+                            [[maybe_unused]] const IntensiveQuantities& intQuantsEx,
+                            [[maybe_unused]] const ResidualNBInfo& nbInfo)
+    {
+        if constexpr (enableEnergy) {
+            flux[contiEnergyEqIdx] = 0.0;
+
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                if (!FluidSystem::phaseIsActive(phaseIdx))
+                    continue;
+
+                if (upIsInterior[phaseIdx])
+                    addPhaseEnthalpyFlux<Evaluation>(flux, phaseIdx, volumeFlux[phaseIdx], intQuantsIn.fluidState());
+                else
+                    addPhaseEnthalpyFlux<Scalar>(flux, phaseIdx, volumeFlux[phaseIdx], intQuantsEx.fluidState());
+            }
+
+            // heat conduction. In contrast to the normal transmissibility, the "thermal
+            // transmissibility" cannot be computed as a preprocessing step because the
+            // average thermal conductivity depends on the solution.
+            const Evaluation& inLambda = intQuantsIn.totalThermalConductivity();
+            const Scalar exLambda = decay<Scalar>(intQuantsEx.totalThermalConductivity());
+            if (inLambda > 0.0 && exLambda > 0.0) {
+                const Evaluation& inH = inLambda*nbInfo.inAlpha;
+                const Scalar exH = exLambda*nbInfo.outAlpha;
+                const Evaluation& H = 1.0/(1.0/inH + 1.0/exH);
+                const Evaluation& deltaT =
+                    decay<Scalar>(intQuantsEx.fluidState().temperature(/*phaseIdx=*/0))
+                    - intQuantsIn.fluidState().temperature(/*phaseIdx=*/0);
+                flux[contiEnergyEqIdx] += deltaT * (-H/nbInfo.faceArea);
+            }
+
+            flux[contiEnergyEqIdx] *= getPropValue<TypeTag, Properties::BlackOilEnergyScalingFactor>();
+        }
+    }
+
+    /*!
+     * \brief Compute the energy flux over a free-flow boundary face for the TPFA
+     *        linearizer.
+     *
+     * The volume fluxes of the phases are given per face area. The enthalpy of the
+     * phases which flow into the domain is taken from the fluid state of the boundary.
+     * The heat conduction is given per face area as well, i.e., the thermal half
+     * transmissibility of the face is divided by its area.
+     */
+    template <class BoundaryFluidState>
+    static void computeBoundaryFlux([[maybe_unused]] RateVector& flux,
+                                    [[maybe_unused]] const std::array<Evaluation, numPhases>& volumeFlux,
+                                    [[maybe_unused]] const std::array<bool, numPhases>& upIsInterior,
+                                    [[maybe_unused]] const IntensiveQuantities& insideIntQuants,
+                                    [[maybe_unused]] const BoundaryFluidState& boundaryFs,
+                                    [[maybe_unused]] Scalar alpha,
+                                    [[maybe_unused]] Scalar faceArea)
+    {
+        if constexpr (enableEnergy) {
+            flux[contiEnergyEqIdx] = 0.0;
+
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                if (!FluidSystem::phaseIsActive(phaseIdx))
+                    continue;
+
+                if (upIsInterior[phaseIdx])
+                    addPhaseEnthalpyFlux<Evaluation>(flux, phaseIdx, volumeFlux[phaseIdx], insideIntQuants.fluidState());
+                else
+                    addPhaseEnthalpyFlux<Scalar>(flux, phaseIdx, volumeFlux[phaseIdx], boundaryFs);
+            }
+
+            // heat conduction
+            const Evaluation& lambda = insideIntQuants.totalThermalConductivity();
+            if (lambda > 0.0) {
+                const Evaluation& deltaT =
+                    boundaryFs.temperature(/*phaseIdx=*/0)
+                    - insideIntQuants.fluidState().temperature(/*phaseIdx=*/0);
+                flux[contiEnergyEqIdx] += deltaT*lambda*(-alpha/faceArea);
+            }
+
+            flux[contiEnergyEqIdx] *= getPropValue<TypeTag, Properties::BlackOilEnergyScalingFactor>();
+        }
+    }
+
+    /*!
+     * \brief Add the enthalpy which is transported by a phase over a face.
+     *
+     * The energy scaling factor is not applied.
+     */
+    template <class UpstreamEval, class FluidState>
+    static void addPhaseEnthalpyFlux(RateVector& flux,
+                                     unsigned phaseIdx,
+                                     const Evaluation& volumeFlux,
+                                     const FluidState& upFs)
+    {
+        flux[contiEnergyEqIdx] +=
+            decay<UpstreamEval>(upFs.enthalpy(phaseIdx))
+            * decay<UpstreamEval>(upFs.density(phaseIdx))
+            * volumeFlux;
+    }
+
     /*!
      * \brief Assign the energy specific primary variables to a PrimaryVariables object
      */
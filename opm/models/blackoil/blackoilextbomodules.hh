@@ -404,6 +404,59 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the flux of the extended black-oil component over a face for the
+     *        TPFA linearizer.
+     *
+     * The volume fluxes are given per face area. If the upstream cell of a phase is not
+     * the interior one, its quantities do not contribute to the derivatives. With
+     * LhsEval being Scalar, only the values are computed.
+     */
+    template <class LhsEval>
+    static void computeFlux([[maybe_unused]] Dune::FieldVector<LhsEval, numEq>& flux,
+                            [[maybe_unused]] const LhsEval& gasVolumeFlux,
+                            [[maybe_unused]] const IntensiveQuantities& upGas,
+                            [[maybe_unused]] bool gasUpIsInterior,
+                            [[maybe_unused]] const LhsEval& oilVolumeFlux,
+                            [[maybe_unused]] const IntensiveQuantities& upOil,
+                            [[maybe_unused]] bool oilUpIsInterior)
+    {
+        if constexpr (enableExtbo) {
+            if constexpr (blackoilConserveSurfaceVolume) {
+                const auto& fsGas = upGas.fluidState();
+                if (gasUpIsInterior)
+                    flux[contiZfracEqIdx] =
+                        gasVolumeFlux
+                        * decay<LhsEval>(upGas.yVolume())
+                        * decay<LhsEval>(fsGas.invB(gasPhaseIdx));
+                else
+                    flux[contiZfracEqIdx] =
+                        gasVolumeFlux
+                        * decay<Scalar>(upGas.yVolume())
+                        * decay<Scalar>(fsGas.invB(gasPhaseIdx));
+
+                if (FluidSystem::enableDissolvedGas()) { // account for dissolved z in oil phase
+                    const auto& fsOil = upOil.fluidState();
+                    if (oilUpIsInterior)
+                        flux[contiZfracEqIdx] +=
+                            oilVolumeFlux
+                            * decay<LhsEval>(upOil.xVolume())
+                            * decay<LhsEval>(fsOil.Rs())
+                            * decay<LhsEval>(fsOil.invB(oilPhaseIdx));
+                    else
+                        flux[contiZfracEqIdx] +=
+                            oilVolumeFlux
+                            * decay<Scalar>(upOil.xVolume())
+                            * decay<Scalar>(fsOil.Rs())
+                            * decay<Scalar>(fsOil.invB(oilPhaseIdx));
+                }
+            }
+            else {
+                throw std::runtime_error("Only component conservation in terms of surface volumes is implemented. ");
+            }
+        }
+    }
+
     /*!
      * \brief Assign the solvent specific primary variables to a PrimaryVariables object
      */
@@ -301,6 +301,33 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the foam flux over a face for the TPFA linearizer.
+     *
+     * The gas volume flux is given per face area. If the upstream cell of the gas phase
+     * is not the interior one, its quantities do not contribute to the derivatives.
+     * With LhsEval being Scalar, only the values are computed.
+     */
+    template <class LhsEval>
+    static void computeFlux([[maybe_unused]] Dune::FieldVector<LhsEval, numEq>& flux,
+                            [[maybe_unused]] const LhsEval& gasVolumeFlux,
+                            [[maybe_unused]] const IntensiveQuantities& up,
+                            [[maybe_unused]] bool upIsInterior)
+    {
+        if constexpr (enableFoam) {
+            if (upIsInterior)
+                flux[contiFoamEqIdx] =
+                    gasVolumeFlux
+                    *decay<LhsEval>(up.fluidState().invB(gasPhaseIdx))
+                    *decay<LhsEval>(up.foamConcentration());
+            else
+                flux[contiFoamEqIdx] =
+                    gasVolumeFlux
+                    *decay<Scalar>(up.fluidState().invB(gasPhaseIdx))
+                    *decay<Scalar>(up.foamConcentration());
+        }
+    }
+
     /*!
      * \brief Return how much a Newton-Raphson update is considered an error
      */
@@ -170,6 +170,10 @@ public:
 
     /*!
      * \copydoc IntensiveQuantities::update
+     *
+     * The quantities are updated one cell at a time. Most of the cost lies in the PVT
+     * relations and the material laws, which are only instantiated for a scalar
+     * evaluation type, so several cells cannot be updated in one batch.
      */
     void update(const ElementContext& elemCtx, unsigned dofIdx, unsigned timeIdx)
     {
@@ -0,0 +1,215 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilIntensiveQuantitiesSoA
+ */
+#ifndef EWOMS_BLACK_OIL_INTENSIVE_QUANTITIES_SOA_HH
+#define EWOMS_BLACK_OIL_INTENSIVE_QUANTITIES_SOA_HH
+
+#include "blackoilproperties.hh"
+
+#include <opm/material/fluidstates/BlackOilFluidState.hpp>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup BlackOilModel
+ *
+ * \brief Structure-of-arrays copy of the parts of the black-oil intensive quantities
+ *        which are required to compute the TPFA flux terms.
+ *
+ * The TPFA flux of a face only needs a handful of quantities of its two adjacent
+ * cells, but the objects for the intensive quantities are large. Gathering these
+ * quantities into one contiguous array per field thus makes the flux loops touch much
+ * less memory. The gathered quantities are the ones of the most recent time index;
+ * they include the derivatives, i.e., they are of type Evaluation.
+ *
+ * Directional relative permeabilities are not supported, i.e., the mobilities stored
+ * here are the ones of IntensiveQuantities::mobility(phaseIdx).
+ */
+template <class TypeTag>
+class BlackOilIntensiveQuantitiesSoA
+{
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using FluidState = typename IntensiveQuantities::FluidState;
+
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+
+public:
+    /*!
+     * \brief Fluid state-like view of the gathered quantities of a single degree of
+     *        freedom.
+     *
+     * This provides the subset of the black-oil fluid state interface which is used by
+     * the get*_() helper functions of the black-oil fluid state when evaluating the
+     * phase fluxes.
+     */
+    class FluidStateView
+    {
+    public:
+        FluidStateView(const BlackOilIntensiveQuantitiesSoA& soa, unsigned globalIdx)
+            : soa_(soa)
+            , globalIdx_(globalIdx)
+        {}
+
+        const Evaluation& invB(unsigned phaseIdx) const
+        { return soa_.invB(phaseIdx, globalIdx_); }
+
+        const Evaluation& Rs() const
+        { return soa_.Rs(globalIdx_); }
+
+        const Evaluation& Rsw() const
+        { return soa_.Rsw(globalIdx_); }
+
+        const Evaluation& Rv() const
+        { return soa_.Rv(globalIdx_); }
+
+        const Evaluation& Rvw() const
+        { return soa_.Rvw(globalIdx_); }
+
+        unsigned pvtRegionIndex() const
+        { return soa_.pvtRegionIndex(globalIdx_); }
+
+    private:
+        const BlackOilIntensiveQuantitiesSoA& soa_;
+        unsigned globalIdx_;
+    };
+
+    /*!
+     * \brief Allocate the arrays for a given number of degrees of freedom.
+     */
+    void resize(std::size_t numDof)
+    {
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            const std::size_t n = FluidSystem::phaseIsActive(phaseIdx) ? numDof : 0;
+            pressure_[phaseIdx].resize(n);
+            density_[phaseIdx].resize(n);
+            mobility_[phaseIdx].resize(n);
+            invB_[phaseIdx].resize(n);
+        }
+
+        rs_.resize(FluidSystem::enableDissolvedGas() ? numDof : 0);
+        rsw_.resize(FluidSystem::enableDissolvedGasInWater() ? numDof : 0);
+        rv_.resize(FluidSystem::enableVaporizedOil() ? numDof : 0);
+        rvw_.resize(FluidSystem::enableVaporizedWater() ? numDof : 0);
+        rockCompTransMultiplier_.resize(numDof);
+        pvtRegionIdx_.resize(numDof);
+    }
+
+    /*!
+     * \brief Returns the number of degrees of freedom for which storage is allocated.
+     */
+    std::size_t size() const
+    { return pvtRegionIdx_.size(); }
+
+    /*!
+     * \brief Copy the relevant quantities of a degree of freedom into the arrays.
+     *
+     * Different degrees of freedom can be updated concurrently.
+     */
+    void update(unsigned globalIdx, const IntensiveQuantities& intQuants)
+    {
+        const auto& fs = intQuants.fluidState();
+        const unsigned pvtRegionIdx = intQuants.pvtRegionIndex();
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            pressure_[phaseIdx][globalIdx] = fs.pressure(phaseIdx);
+            density_[phaseIdx][globalIdx] = fs.density(phaseIdx);
+            mobility_[phaseIdx][globalIdx] = intQuants.mobility(phaseIdx);
+            invB_[phaseIdx][globalIdx] =
+                getInvB_<FluidSystem, FluidState, Evaluation>(fs, phaseIdx, pvtRegionIdx);
+        }
+
+        if (FluidSystem::enableDissolvedGas())
+            rs_[globalIdx] = BlackOil::getRs_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx);
+        if (FluidSystem::enableDissolvedGasInWater())
+            rsw_[globalIdx] = BlackOil::getRsw_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx);
+        if (FluidSystem::enableVaporizedOil())
+            rv_[globalIdx] = BlackOil::getRv_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx);
+        if (FluidSystem::enableVaporizedWater())
+            rvw_[globalIdx] = BlackOil::getRvw_<FluidSystem, FluidState, Evaluation>(fs, pvtRegionIdx);
+
+        rockCompTransMultiplier_[globalIdx] = intQuants.rockCompTransMultiplier();
+        pvtRegionIdx_[globalIdx] = static_cast<unsigned short>(pvtRegionIdx);
+    }
+
+    const Evaluation& pressure(unsigned phaseIdx, unsigned globalIdx) const
+    { return pressure_[phaseIdx][globalIdx]; }
+
+    const Evaluation& density(unsigned phaseIdx, unsigned globalIdx) const
+    { return density_[phaseIdx][globalIdx]; }
+
+    const Evaluation& mobility(unsigned phaseIdx, unsigned globalIdx) const
+    { return mobility_[phaseIdx][globalIdx]; }
+
+    const Evaluation& invB(unsigned phaseIdx, unsigned globalIdx) const
+    { return invB_[phaseIdx][globalIdx]; }
+
+    const Evaluation& Rs(unsigned globalIdx) const
+    { return rs_[globalIdx]; }
+
+    const Evaluation& Rsw(unsigned globalIdx) const
+    { return rsw_[globalIdx]; }
+
+    const Evaluation& Rv(unsigned globalIdx) const
+    { return rv_[globalIdx]; }
+
+    const Evaluation& Rvw(unsigned globalIdx) const
+    { return rvw_[globalIdx]; }
+
+    const Evaluation& rockCompTransMultiplier(unsigned globalIdx) const
+    { return rockCompTransMultiplier_[globalIdx]; }
+
+    unsigned pvtRegionIndex(unsigned globalIdx) const
+    { return pvtRegionIdx_[globalIdx]; }
+
+    FluidStateView fluidState(unsigned globalIdx) const
+    { return FluidStateView(*this, globalIdx); }
+
+private:
+    std::array<std::vector<Evaluation>, numPhases> pressure_;
+    std::array<std::vector<Evaluation>, numPhases> density_;
+    std::array<std::vector<Evaluation>, numPhases> mobility_;
+    std::array<std::vector<Evaluation>, numPhases> invB_;
+    std::vector<Evaluation> rs_;
+    std::vector<Evaluation> rsw_;
+    std::vector<Evaluation> rv_;
+    std::vector<Evaluation> rvw_;
+    std::vector<Evaluation> rockCompTransMultiplier_;
+    std::vector<unsigned short> pvtRegionIdx_;
+};
+
+} // namespace Opm
+
+#endif
@@ -29,6 +29,7 @@
 #define EWOMS_BLACK_OIL_LOCAL_TPFA_RESIDUAL_HH
 
 #include "blackoilproperties.hh"
+#include "blackoilintensivequantitiessoa.hh"
 #include "blackoilsolventmodules.hh"
 #include "blackoilextbomodules.hh"
 #include "blackoilpolymermodules.hh"
@@ -40,6 +41,8 @@
 #include <opm/material/fluidstates/BlackOilFluidState.hpp>
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
 
+#include <array>
+
 
 namespace Opm {
 /*!
@@ -106,6 +109,98 @@ class BlackOilLocalResidualTPFA : public GetPropType<TypeTag, Properties::DiscLo
     using Toolbox = MathToolbox<Evaluation>;
 
 public:
+    using IntensiveQuantitiesSoA = BlackOilIntensiveQuantitiesSoA<TypeTag>;
+
+    /*!
+     * \brief The parameters of a face which do not depend on the solution.
+     *
+     * These are stored by the linearizer for each cell and each of its neighbors, so
+     * that the fluxes can be computed without querying the problem.
+     */
+    struct ResidualNBInfo
+    {
+        Scalar trans; //!< transmissibility of the face
+        Scalar faceArea; //!< area of the face
+        Scalar thpres; //!< threshold pressure between the two cells
+        Scalar dZg; //!< depth difference of the cells times the gravity
+        Scalar Vin; //!< total volume of the interior cell
+        Scalar Vex; //!< total volume of the exterior cell
+        FaceDir::DirEnum faceDir; //!< direction of the face
+        Scalar dist; //!< distance between the centers of the cells, used by SHRATE
+        Scalar inAlpha; //!< thermal half transmissibility of the interior cell
+        Scalar outAlpha; //!< thermal half transmissibility of the exterior cell
+        Scalar diffusivity; //!< diffusivity of the face divided by its area
+        Scalar Swcr; //!< critical water saturation of the interior cell, used by PLYSHLOG
+    };
+
+    /*!
+     * \brief Specifies whether the fluxes can be computed from the structure-of-arrays
+     *        copy of the intensive quantities.
+     *
+     * The fluxes of the extension modules need the full intensive quantities.
+     */
+    static constexpr bool intensiveQuantitiesSoASupported =
+        !(enableSolvent || enableExtbo || enablePolymer || enableEnergy ||
+          enableFoam || enableBrine || enableDiffusion || enableMICP);
+
+    /*!
+     * \brief Compute the solution independent parameters of a face from the problem.
+     *
+     * The distance between the centers of the cells is only required if polymers are
+     * considered with SHRATE.
+     */
+    static ResidualNBInfo residualNBInfo(const Problem& problem,
+                                         const unsigned globalIndexIn,
+                                         const unsigned globalIndexEx,
+                                         const Scalar trans,
+                                         const Scalar faceArea,
+                                         const Scalar dist,
+                                         const FaceDir::DirEnum facedir)
+    {
+        // estimate the gravity correction: for performance reasons we use a simplified
+        // approach for this flux module that assumes that gravity is constant and always
+        // acts into the downwards direction. (i.e., no centrifuge experiments, sorry.)
+        Scalar g = problem.gravity()[dimWorld - 1];
+
+        // this is quite hacky because the dune grid interface does not provide a
+        // cellCenterDepth() method (so we ask the problem to provide it). The "good"
+        // solution would be to take the Z coordinate of the element centroids, but since
+        // ECL seems to like to be inconsistent on that front, it needs to be done like
+        // here...
+        Scalar zIn = problem.dofCenterDepth(globalIndexIn);
+        Scalar zEx = problem.dofCenterDepth(globalIndexEx);
+
+        // the distances from the DOF's depths. (i.e., the additional depth of the
+        // exterior DOF)
+        Scalar distZ = zIn - zEx;
+
+        ResidualNBInfo nbInfo{trans,
+                              faceArea,
+                              problem.thresholdPressure(globalIndexIn, globalIndexEx),
+                              distZ * g,
+                              problem.model().dofTotalVolume(globalIndexIn),
+                              problem.model().dofTotalVolume(globalIndexEx),
+                              facedir,
+                              dist,
+                              /*inAlpha=*/0.0,
+                              /*outAlpha=*/0.0,
+                              /*diffusivity=*/0.0,
+                              /*Swcr=*/0.0};
+
+        if constexpr (enableEnergy) {
+            nbInfo.inAlpha = problem.thermalHalfTransmissibility(globalIndexIn, globalIndexEx);
+            nbInfo.outAlpha = problem.thermalHalfTransmissibility(globalIndexEx, globalIndexIn);
+        }
+
+        if constexpr (enableDiffusion)
+            nbInfo.diffusivity = problem.diffusivity(globalIndexIn, globalIndexEx) / faceArea;
+
+        if constexpr (enablePolymer)
+            nbInfo.Swcr = problem.materialLawManager()->oilWaterScaledEpsInfoDrainage(globalIndexIn).Swcr;
+
+        return nbInfo;
+    }
+
     /*!
      * \copydoc FvBaseLocalResidual::computeStorage
      */
@@ -213,45 +308,38 @@ public:
                             const Scalar trans,
                             const Scalar faceArea,
                             const FaceDir::DirEnum facedir)
+    {
+        computeFlux(flux,
+                    darcy,
+                    globalIndexIn,
+                    globalIndexEx,
+                    intQuantsIn,
+                    intQuantsEx,
+                    residualNBInfo(problem, globalIndexIn, globalIndexEx, trans, faceArea, /*dist=*/0.0, facedir));
+    }
+
+    /*!
+     * \brief Compute the flux over a face using the precomputed parameters of the face.
+     */
+    static void computeFlux(RateVector& flux,
+                            RateVector& darcy,
+                            const unsigned globalIndexIn,
+                            const unsigned globalIndexEx,
+                            const IntensiveQuantities& intQuantsIn,
+                            const IntensiveQuantities& intQuantsEx,
+                            const ResidualNBInfo& nbInfo)
     {
         OPM_TIMEBLOCK_LOCAL(computeFlux);
         flux = 0.0;
         darcy = 0.0;
-        Scalar Vin = problem.model().dofTotalVolume(globalIndexIn);
-        Scalar Vex = problem.model().dofTotalVolume(globalIndexEx);
-
-        Scalar thpres = problem.thresholdPressure(globalIndexIn, globalIndexEx);
-
-        // estimate the gravity correction: for performance reasons we use a simplified
-        // approach for this flux module that assumes that gravity is constant and always
-        // acts into the downwards direction. (i.e., no centrifuge experiments, sorry.)
-        Scalar g = problem.gravity()[dimWorld - 1];
-
-        // this is quite hacky because the dune grid interface does not provide a
-        // cellCenterDepth() method (so we ask the problem to provide it). The "good"
-        // solution would be to take the Z coordinate of the element centroids, but since
-        // ECL seems to like to be inconsistent on that front, it needs to be done like
-        // here...
-        Scalar zIn = problem.dofCenterDepth(globalIndexIn);
-        Scalar zEx = problem.dofCenterDepth(globalIndexEx);
-
-        // the distances from the DOF's depths. (i.e., the additional depth of the
-        // exterior DOF)
-        Scalar distZ = zIn - zEx; // NB could be precalculated
 
         calculateFluxes_(flux,
                          darcy,
                          intQuantsIn,
                          intQuantsEx,
-                         Vin,
-                         Vex,
                          globalIndexIn,
                          globalIndexEx,
-                         distZ * g,
-                         thpres,
-                         trans,
-                         faceArea,
-                         facedir);
+                         nbInfo);
     }
 
     // This function demonstrates compatibility with the ElementContext-based interface.
@@ -310,36 +398,60 @@ public:
         // exterior DOF)
         Scalar distZ = zIn - zEx;
 
+        ResidualNBInfo nbInfo{trans,
+                              faceArea,
+                              thpres,
+                              distZ * g,
+                              Vin,
+                              Vex,
+                              facedir,
+                              (elemCtx.pos(interiorDofIdx, timeIdx) - elemCtx.pos(exteriorDofIdx, timeIdx)).two_norm(),
+                              /*inAlpha=*/0.0,
+                              /*outAlpha=*/0.0,
+                              /*diffusivity=*/0.0,
+                              /*Swcr=*/0.0};
+
+        if constexpr (enableEnergy) {
+            nbInfo.inAlpha = problem.thermalHalfTransmissibilityIn(elemCtx, scvfIdx, timeIdx);
+            nbInfo.outAlpha = problem.thermalHalfTransmissibilityOut(elemCtx, scvfIdx, timeIdx);
+        }
+
+        if constexpr (enableDiffusion)
+            nbInfo.diffusivity = problem.diffusivity(elemCtx, interiorDofIdx, exteriorDofIdx) / faceArea;
+
+        if constexpr (enablePolymer)
+            nbInfo.Swcr = materialLawManager->oilWaterScaledEpsInfoDrainage(globalIndexIn).Swcr;
+
         calculateFluxes_(flux,
                          darcy,
                          intQuantsIn,
                          intQuantsEx,
-                         Vin,
-                         Vex,
                          globalIndexIn,
                          globalIndexEx,
-                         distZ * g,
-                         thpres,
-                         trans,
-                         faceArea,
-                         facedir);
+                         nbInfo);
     }
 
     static void calculateFluxes_(RateVector& flux,
                                  RateVector& darcy,
                                  const IntensiveQuantities& intQuantsIn,
                                  const IntensiveQuantities& intQuantsEx,
-                                 const Scalar& Vin,
-                                 const Scalar& Vex,
                                  const unsigned& globalIndexIn,
                                  const unsigned& globalIndexEx,
-                                 const Scalar& distZg,
-                                 const Scalar& thpres,
-                                 const Scalar& trans,
-                                 const Scalar& faceArea,
-                                 const FaceDir::DirEnum facedir)
+                                 const ResidualNBInfo& nbInfo)
     {
         OPM_TIMEBLOCK_LOCAL(calculateFluxes);
+        const Scalar Vin = nbInfo.Vin;
+        const Scalar Vex = nbInfo.Vex;
+        const Scalar distZg = nbInfo.dZg;
+        const Scalar thpres = nbInfo.thpres;
+        const Scalar trans = nbInfo.trans;
+        const Scalar faceArea = nbInfo.faceArea;
+        const FaceDir::DirEnum facedir = nbInfo.faceDir;
+
+        // the volume fluxes and the upstream cells of the phases are also required by
+        // the extension modules
+        std::array<Evaluation, numPhases> volumeFlux;
+        std::array<bool, numPhases> upIsInterior;
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!FluidSystem::phaseIsActive(phaseIdx))
                 continue;
@@ -383,6 +495,8 @@ public:
             }
             unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
             darcy[conti0EqIdx + activeCompIdx] = darcyFlux.value() * faceArea; // For the FLORES fluxes
+            volumeFlux[phaseIdx] = darcyFlux;
+            upIsInterior[phaseIdx] = (globalUpIndex == globalIndexIn);
 
             unsigned pvtRegionIdx = up.pvtRegionIndex();
             // if (upIdx == globalFocusDofIdx){
@@ -400,38 +514,307 @@ public:
             }
         }
 
+        // the upstream intensive quantities of a phase
+        [[maybe_unused]] const auto upstream = [&](unsigned phaseIdx) -> const IntensiveQuantities&
+        { return upIsInterior[phaseIdx] ? intQuantsIn : intQuantsEx; };
+
         // deal with solvents (if present)
-        static_assert(!enableSolvent, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // SolventModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableSolvent)
+            SolventModule::computeFlux(flux, intQuantsIn, intQuantsEx, nbInfo);
 
         // deal with zFracton (if present)
-        static_assert(!enableExtbo, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // ExtboModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableExtbo)
+            ExtboModule::computeFlux(flux,
+                                     volumeFlux[gasPhaseIdx], upstream(gasPhaseIdx), upIsInterior[gasPhaseIdx],
+                                     volumeFlux[oilPhaseIdx], upstream(oilPhaseIdx), upIsInterior[oilPhaseIdx]);
 
         // deal with polymer (if present)
-        static_assert(!enablePolymer, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // PolymerModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enablePolymer)
+            PolymerModule::computeFlux(flux,
+                                       volumeFlux[waterPhaseIdx], upstream(waterPhaseIdx), upIsInterior[waterPhaseIdx],
+                                       intQuantsIn, intQuantsEx, nbInfo);
 
         // deal with energy (if present)
-        static_assert(!enableEnergy, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // EnergyModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableEnergy)
+            EnergyModule::computeFlux(flux, volumeFlux, upIsInterior, intQuantsIn, intQuantsEx, nbInfo);
 
         // deal with foam (if present)
-        static_assert(!enableFoam, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // FoamModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableFoam)
+            FoamModule::computeFlux(flux, volumeFlux[gasPhaseIdx], upstream(gasPhaseIdx), upIsInterior[gasPhaseIdx]);
 
         // deal with salt (if present)
-        static_assert(!enableBrine, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // BrineModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableBrine)
+            BrineModule::computeFlux(flux, volumeFlux[waterPhaseIdx], upstream(waterPhaseIdx), upIsInterior[waterPhaseIdx]);
 
         // deal with diffusion (if present)
-        static_assert(!enableDiffusion, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // DiffusionModule::addDiffusiveFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableDiffusion)
+            DiffusionModule::addDiffusiveFlux(flux, intQuantsIn, intQuantsEx, nbInfo.diffusivity);
 
         // deal with micp (if present)
-        static_assert(!enableMICP, "Relevant computeFlux() method must be implemented for this module before enabling.");
-        // MICPModule::computeFlux(flux, elemCtx, scvfIdx, timeIdx);
+        if constexpr (enableMICP)
+            MICPModule::computeFlux(flux, volumeFlux[waterPhaseIdx], upstream(waterPhaseIdx), upIsInterior[waterPhaseIdx]);
+    }
+
+    /*!
+     * \brief Compute the flux over a face using the gathered intensive quantities.
+     *
+     * This yields the same result as the computeFlux() method which takes the objects
+     * for the intensive quantities, but it only reads the contiguous arrays of the
+     * structure-of-arrays cache. Directional relative permeabilities are not supported.
+     */
+    static void computeFlux(RateVector& flux,
+                            RateVector& darcy,
+                            const unsigned globalIndexIn,
+                            const unsigned globalIndexEx,
+                            const IntensiveQuantitiesSoA& soa,
+                            const ResidualNBInfo& nbInfo)
+    {
+        OPM_TIMEBLOCK_LOCAL(computeFlux);
+        flux = 0.0;
+        darcy = 0.0;
+        const Scalar trans = nbInfo.trans;
+        const Scalar faceArea = nbInfo.faceArea;
+
+        using UpFluidState = typename IntensiveQuantitiesSoA::FluidStateView;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            unsigned globalUpIndex;
+            Evaluation pressureDifference;
+            calculatePhasePressureDiff_(globalUpIndex,
+                                        pressureDifference,
+                                        soa,
+                                        phaseIdx,
+                                        nbInfo.Vin,
+                                        nbInfo.Vex,
+                                        globalIndexIn,
+                                        globalIndexEx,
+                                        nbInfo.dZg,
+                                        nbInfo.thpres);
+
+            const Evaluation& transMult = soa.rockCompTransMultiplier(globalUpIndex);
+            const Evaluation& mobility = soa.mobility(phaseIdx, globalUpIndex);
+            Evaluation darcyFlux;
+            if (pressureDifference == 0) {
+                darcyFlux = 0.0;
+            } else {
+                if (globalUpIndex == globalIndexIn)
+                    darcyFlux = pressureDifference * mobility * transMult * (-trans / faceArea);
+                else
+                    darcyFlux = pressureDifference *
+                       (Toolbox::value(mobility) * Toolbox::value(transMult) * (-trans / faceArea));
+            }
+            unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
+            darcy[conti0EqIdx + activeCompIdx] = darcyFlux.value() * faceArea; // For the FLORES fluxes
+
+            unsigned pvtRegionIdx = soa.pvtRegionIndex(globalUpIndex);
+            const UpFluidState upFs = soa.fluidState(globalUpIndex);
+            if (globalUpIndex == globalIndexIn) {
+                const auto& invB
+                    = getInvB_<FluidSystem, UpFluidState, Evaluation>(upFs, phaseIdx, pvtRegionIdx);
+                const auto& surfaceVolumeFlux = invB * darcyFlux;
+                evalPhaseFluxes_<Evaluation, Evaluation, UpFluidState>(
+                    flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, upFs);
+            } else {
+                const auto& invB = getInvB_<FluidSystem, UpFluidState, Scalar>(upFs, phaseIdx, pvtRegionIdx);
+                const auto& surfaceVolumeFlux = invB * darcyFlux;
+                evalPhaseFluxes_<Scalar, Evaluation, UpFluidState>(
+                    flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, upFs);
+            }
+        }
+    }
+
+    /*!
+     * \brief Compute the values of the flux over a face without any derivatives.
+     *
+     * This is used if only the residual is requested. Apart from the missing
+     * derivatives, the result is the same as the one of the computeFlux() method which
+     * takes the objects for the intensive quantities. The upstream direction of the
+     * phases is determined like for the structure-of-arrays copy. The fluxes of the
+     * solvent, polymer, energy, diffusion and MICP modules are only available with
+     * derivatives, so these are computed by the computeFlux() method if any of these
+     * modules is enabled.
+     */
+    static void computeFluxValues(Dune::FieldVector<Scalar, numEq>& flux,
+                                  Dune::FieldVector<Scalar, numEq>& darcy,
+                                  const unsigned globalIndexIn,
+                                  const unsigned globalIndexEx,
+                                  const IntensiveQuantities& intQuantsIn,
+                                  const IntensiveQuantities& intQuantsEx,
+                                  const ResidualNBInfo& nbInfo)
+    {
+        OPM_TIMEBLOCK_LOCAL(computeFluxValues);
+        if constexpr (enableSolvent || enablePolymer || enableEnergy || enableDiffusion || enableMICP) {
+            RateVector evalFlux;
+            RateVector evalDarcy;
+            computeFlux(evalFlux, evalDarcy, globalIndexIn, globalIndexEx, intQuantsIn, intQuantsEx, nbInfo);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                flux[eqIdx] = Toolbox::value(evalFlux[eqIdx]);
+                darcy[eqIdx] = Toolbox::value(evalDarcy[eqIdx]);
+            }
+            return;
+        }
+
+        flux = 0.0;
+        darcy = 0.0;
+        const Scalar trans = nbInfo.trans;
+        const Scalar faceArea = nbInfo.faceArea;
+
+        std::array<Scalar, numPhases> volumeFlux;
+        std::array<bool, numPhases> upIsInterior;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            const auto& fsIn = intQuantsIn.fluidState();
+            const auto& fsEx = intQuantsEx.fluidState();
+            unsigned globalUpIndex = globalIndexIn;
+            Scalar pressureDifference = 0.0;
+            if (intQuantsIn.mobility(phaseIdx) > 0.0 || intQuantsEx.mobility(phaseIdx) > 0.0)
+                calculatePhasePressureDiff_(globalUpIndex,
+                                            pressureDifference,
+                                            Toolbox::value(fsIn.density(phaseIdx)),
+                                            Toolbox::value(fsEx.density(phaseIdx)),
+                                            Toolbox::value(fsIn.pressure(phaseIdx)),
+                                            Toolbox::value(fsEx.pressure(phaseIdx)),
+                                            nbInfo.Vin,
+                                            nbInfo.Vex,
+                                            globalIndexIn,
+                                            globalIndexEx,
+                                            nbInfo.dZg,
+                                            nbInfo.thpres);
+
+            const IntensiveQuantities& up = (globalUpIndex == globalIndexIn) ? intQuantsIn : intQuantsEx;
+            const Scalar mobility = Toolbox::value(up.mobility(phaseIdx, nbInfo.faceDir));
+            const Scalar transMult = Toolbox::value(up.rockCompTransMultiplier());
+            Scalar darcyFlux = 0.0;
+            if (pressureDifference != 0.0) {
+                // same order of operations as in calculateFluxes_()
+                if (globalUpIndex == globalIndexIn)
+                    darcyFlux = pressureDifference * mobility * transMult * (-trans / faceArea);
+                else
+                    darcyFlux = pressureDifference * (mobility * transMult * (-trans / faceArea));
+            }
+            unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
+            darcy[conti0EqIdx + activeCompIdx] = darcyFlux * faceArea; // For the FLORES fluxes
+            volumeFlux[phaseIdx] = darcyFlux;
+            upIsInterior[phaseIdx] = (globalUpIndex == globalIndexIn);
+
+            unsigned pvtRegionIdx = up.pvtRegionIndex();
+            const Scalar invB = getInvB_<FluidSystem, FluidState, Scalar>(up.fluidState(), phaseIdx, pvtRegionIdx);
+            const Scalar surfaceVolumeFlux = invB * darcyFlux;
+            evalPhaseFluxes_<Scalar, Scalar, FluidState>(
+                flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
+        }
 
+        // the upstream intensive quantities of a phase
+        [[maybe_unused]] const auto upstream = [&](unsigned phaseIdx) -> const IntensiveQuantities&
+        { return upIsInterior[phaseIdx] ? intQuantsIn : intQuantsEx; };
+
+        // deal with the extension modules which are able to compute values only
+        if constexpr (enableExtbo)
+            ExtboModule::computeFlux(flux,
+                                     volumeFlux[gasPhaseIdx], upstream(gasPhaseIdx), upIsInterior[gasPhaseIdx],
+                                     volumeFlux[oilPhaseIdx], upstream(oilPhaseIdx), upIsInterior[oilPhaseIdx]);
+        if constexpr (enableFoam)
+            FoamModule::computeFlux(flux, volumeFlux[gasPhaseIdx], upstream(gasPhaseIdx), upIsInterior[gasPhaseIdx]);
+        if constexpr (enableBrine)
+            BrineModule::computeFlux(flux, volumeFlux[waterPhaseIdx], upstream(waterPhaseIdx), upIsInterior[waterPhaseIdx]);
+    }
+
+    /*!
+     * \brief Compute the pressure difference of a phase over a face and determine the
+     *        upstream degree of freedom from the gathered intensive quantities.
+     */
+    static void calculatePhasePressureDiff_(unsigned& globalUpIndex,
+                                            Evaluation& pressureDifference,
+                                            const IntensiveQuantitiesSoA& soa,
+                                            const unsigned phaseIdx,
+                                            const Scalar Vin,
+                                            const Scalar Vex,
+                                            const unsigned globalIndexIn,
+                                            const unsigned globalIndexEx,
+                                            const Scalar distZg,
+                                            const Scalar thpres)
+    {
+        // if the phase is immobile on both sides, there is nothing to do
+        if (soa.mobility(phaseIdx, globalIndexIn) <= 0.0 &&
+            soa.mobility(phaseIdx, globalIndexEx) <= 0.0)
+        {
+            globalUpIndex = globalIndexIn;
+            pressureDifference = 0.0;
+            return;
+        }
+
+        calculatePhasePressureDiff_(globalUpIndex,
+                                    pressureDifference,
+                                    soa.density(phaseIdx, globalIndexIn),
+                                    Toolbox::value(soa.density(phaseIdx, globalIndexEx)),
+                                    soa.pressure(phaseIdx, globalIndexIn),
+                                    Toolbox::value(soa.pressure(phaseIdx, globalIndexEx)),
+                                    Vin,
+                                    Vex,
+                                    globalIndexIn,
+                                    globalIndexEx,
+                                    distZg,
+                                    thpres);
+    }
+
+    /*!
+     * \brief Compute the pressure difference of a phase over a face and determine the
+     *        upstream degree of freedom from the densities and pressures of the cells.
+     *
+     * The rules are the ones of ExtensiveQuantities::calculatePhasePressureDiff_(): The
+     * pressure of the exterior degree of freedom is corrected by the hydrostatic
+     * pressure, if the pressures are equal the degree of freedom with the larger volume
+     * or, if these are equal as well, the smaller index is upstream and the threshold
+     * pressure is subtracted from the pressure difference. Only the quantities of the
+     * interior degree of freedom carry derivatives.
+     */
+    template <class LhsEval>
+    static void calculatePhasePressureDiff_(unsigned& globalUpIndex,
+                                            LhsEval& pressureDifference,
+                                            const LhsEval& rhoIn,
+                                            const Scalar rhoEx,
+                                            const LhsEval& pressureInterior,
+                                            const Scalar pressureEx,
+                                            const Scalar Vin,
+                                            const Scalar Vex,
+                                            const unsigned globalIndexIn,
+                                            const unsigned globalIndexEx,
+                                            const Scalar distZg,
+                                            const Scalar thpres)
+    {
+        // do the gravity correction: compute the hydrostatic pressure for the
+        // exterior DOF at the depth of the interior one
+        LhsEval rhoAvg = (rhoIn + rhoEx)/2;
+
+        LhsEval pressureExterior = pressureEx;
+        pressureExterior += rhoAvg*distZg;
+
+        pressureDifference = pressureExterior - pressureInterior;
+
+        if (pressureDifference > 0.0)
+            globalUpIndex = globalIndexEx;
+        else if (pressureDifference < 0.0)
+            globalUpIndex = globalIndexIn;
+        else if (Vin != Vex)
+            globalUpIndex = (Vin > Vex) ? globalIndexIn : globalIndexEx;
+        else
+            globalUpIndex = std::min(globalIndexIn, globalIndexEx);
+
+        // apply the threshold pressure for the intersection
+        if (thpres > 0.0) {
+            if (std::abs(getValue(pressureDifference)) > thpres) {
+                if (pressureDifference < 0.0)
+                    pressureDifference += thpres;
+                else
+                    pressureDifference -= thpres;
+            }
+            else
+                pressureDifference = 0.0;
+        }
     }
 
     template <class BoundaryConditionData>
@@ -485,6 +868,8 @@ public:
         // advective fluxes of all components in all phases
         ////////
         bdyFlux = 0.0;
+        std::array<Evaluation, numPhases> phaseVolumeFlux;
+        std::array<bool, numPhases> upIsInterior;
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!FluidSystem::phaseIsActive(phaseIdx)) {
                 continue;
@@ -521,19 +906,38 @@ public:
                 bdyFlux[i] += tmp[i];
             }
 
-            static_assert(!enableEnergy, "Relevant treatment of boundary conditions must be implemented before enabling.");
-            // Add energy flux treatment per phase here.
+            phaseVolumeFlux[phaseIdx] = volumeFlux[phaseIdx];
+            upIsInterior[phaseIdx] = !(pBoundary > pInside);
         }
 
-        static_assert(!enableSolvent, "Relevant treatment of boundary conditions must be implemented before enabling.");
-        static_assert(!enablePolymer, "Relevant treatment of boundary conditions must be implemented before enabling.");
-        static_assert(!enableMICP, "Relevant treatment of boundary conditions must be implemented before enabling.");
+        // the fluid state of the boundary does not specify any solvent, so it neither
+        // flows into nor out of the domain
+        if constexpr (enableSolvent)
+            bdyFlux[Indices::contiSolventEqIdx] = 0.0;
+
+        if constexpr (enablePolymer)
+            bdyFlux[Indices::contiPolymerEqIdx] =
+                volumeFlux[waterPhaseIdx] * insideIntQuants.polymerConcentration();
+
+        if constexpr (enableMICP) {
+            bdyFlux[Indices::contiMicrobialEqIdx] = volumeFlux[waterPhaseIdx] * insideIntQuants.microbialConcentration();
+            bdyFlux[Indices::contiOxygenEqIdx] = volumeFlux[waterPhaseIdx] * insideIntQuants.oxygenConcentration();
+            bdyFlux[Indices::contiUreaEqIdx] = volumeFlux[waterPhaseIdx] * insideIntQuants.ureaConcentration();
+        }
 
         // make sure that the right mass conservation quantities are used
         adaptMassConservationQuantities_(bdyFlux, insideIntQuants.pvtRegionIndex());
 
-        // heat conduction
-        static_assert(!enableEnergy, "Relevant treatment of boundary conditions must be implemented before enabling.");
+        // enthalpy transported by the phases and heat conduction
+        if constexpr (enableEnergy)
+            EnergyModule::computeBoundaryFlux(bdyFlux,
+                                              phaseVolumeFlux,
+                                              upIsInterior,
+                                              insideIntQuants,
+                                              bdyInfo.exFluidState,
+                                              problem.thermalHalfTransmissibilityBoundary(globalSpaceIdx,
+                                                                                          bdyInfo.boundaryFaceIndex),
+                                              bdyInfo.faceArea);
 
 #ifndef NDEBUG
         for (unsigned i = 0; i < numEq; ++i) {
@@ -543,8 +947,17 @@ public:
 #endif
     }
 
+    /*!
+     * \brief Compute the source term of a cell for the TPFA linearizer.
+     *
+     * The neighbors of the cell are only used by the MICP module which needs the
+     * pressure gradient of water in the center of the cell.
+     */
+    template <class NeighborInfos>
     static void computeSource(RateVector& source,
                               const Problem& problem,
+                              [[maybe_unused]] const IntensiveQuantities& intQuants,
+                              [[maybe_unused]] const NeighborInfos& nbInfos,
                               unsigned globalSpaceIdex,
                               unsigned timeIdx)
     {
@@ -553,17 +966,25 @@ public:
         problem.source(source, globalSpaceIdex, timeIdx);
 
         // deal with MICP (if present)
-        // deal with micp (if present)
-        static_assert(!enableMICP, "Relevant addSource() method must be implemented for this module before enabling.");
-        // MICPModule::addSource(source, elemCtx, dofIdx, timeIdx);
+        if constexpr (enableMICP)
+            MICPModule::addSource(source,
+                                  intQuants,
+                                  waterPressureGradient_(problem, intQuants, nbInfos, globalSpaceIdex));
 
         // scale the source term of the energy equation
         if (enableEnergy)
             source[Indices::contiEnergyEqIdx] *= getPropValue<TypeTag, Properties::BlackOilEnergyScalingFactor>();
     }
 
+    /*!
+     * \brief Compute the source term of a cell without the sparse source terms for the
+     *        TPFA linearizer.
+     */
+    template <class NeighborInfos>
     static void computeSourceDense(RateVector& source,
                                    const Problem& problem,
+                                   [[maybe_unused]] const IntensiveQuantities& intQuants,
+                                   [[maybe_unused]] const NeighborInfos& nbInfos,
                                    unsigned globalSpaceIdex,
                                    unsigned timeIdx)
     {
@@ -571,15 +992,68 @@ public:
         problem.addToSourceDense(source, globalSpaceIdex, timeIdx);
 
         // deal with MICP (if present)
-        // deal with micp (if present)
-        static_assert(!enableMICP, "Relevant addSource() method must be implemented for this module before enabling.");
-        // MICPModule::addSource(source, elemCtx, dofIdx, timeIdx);
+        if constexpr (enableMICP)
+            MICPModule::addSource(source,
+                                  intQuants,
+                                  waterPressureGradient_(problem, intQuants, nbInfos, globalSpaceIdex));
 
         // scale the source term of the energy equation
         if (enableEnergy)
             source[Indices::contiEnergyEqIdx] *= getPropValue<TypeTag, Properties::BlackOilEnergyScalingFactor>();
     }
 
+    /*!
+     * \brief Compute the maximum norm of the pressure gradient of water in the center
+     *        of a cell from the faces to its neighbors.
+     *
+     * This is the water velocity over the faces divided by the permeability and the
+     * mobility of water, see BlackOilMICPModule::addSource(). The mobility cancels out,
+     * so it is not evaluated. Only the quantities of the cell carry derivatives.
+     */
+    template <class NeighborInfos>
+    static Evaluation waterPressureGradient_(const Problem& problem,
+                                             const IntensiveQuantities& intQuantsIn,
+                                             const NeighborInfos& nbInfos,
+                                             unsigned globalIndexIn)
+    {
+        const Scalar K = problem.intrinsicPermeability(globalIndexIn)[0][0];
+        const auto& fsIn = intQuantsIn.fluidState();
+        Evaluation dpW = 0.0;
+        for (const auto& nbInfo : nbInfos) {
+            const unsigned globalIndexEx = nbInfo.neighbor;
+            const IntensiveQuantities* intQuantsExP =
+                problem.model().cachedIntensiveQuantities(globalIndexEx, /*timeIdx=*/0);
+            if (intQuantsExP == nullptr) {
+                throw std::logic_error("Missing updated intensive quantities for cell " + std::to_string(globalIndexEx));
+            }
+            const auto& fsEx = intQuantsExP->fluidState();
+            const ResidualNBInfo& resNBInfo = nbInfo.resNBInfo;
+
+            unsigned globalUpIndex;
+            Evaluation pressureDifference;
+            calculatePhasePressureDiff_(globalUpIndex,
+                                        pressureDifference,
+                                        fsIn.density(waterPhaseIdx),
+                                        Toolbox::value(fsEx.density(waterPhaseIdx)),
+                                        fsIn.pressure(waterPhaseIdx),
+                                        Toolbox::value(fsEx.pressure(waterPhaseIdx)),
+                                        resNBInfo.Vin,
+                                        resNBInfo.Vex,
+                                        globalIndexIn,
+                                        globalIndexEx,
+                                        resNBInfo.dZg,
+                                        resNBInfo.thpres);
+
+            Evaluation waterVolumeVelocity = pressureDifference * (-resNBInfo.trans / resNBInfo.faceArea) / K;
+            if (globalUpIndex == globalIndexIn)
+                waterVolumeVelocity *= intQuantsIn.rockCompTransMultiplier();
+            else
+                waterVolumeVelocity *= Toolbox::value(intQuantsExP->rockCompTransMultiplier());
+            dpW = std::max(dpW, abs(waterVolumeVelocity));
+        }
+        return dpW;
+    }
+
     /*!
      * \copydoc FvBaseLocalResidual::computeSource
      */
@@ -617,8 +1091,8 @@ public:
      * \brief Helper function to calculate the flux of mass in terms of conservation
      *        quantities via specific fluid phase over a face.
      */
-    template <class UpEval, class Eval,class FluidState>
-    static void evalPhaseFluxes_(RateVector& flux,
+    template <class UpEval, class Eval, class FluidState, class FluxVector>
+    static void evalPhaseFluxes_(FluxVector& flux,
                                  unsigned phaseIdx,
                                  unsigned pvtRegionIdx,
                                  const Eval& surfaceVolumeFlux,
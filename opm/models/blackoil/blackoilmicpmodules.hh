@@ -290,6 +290,33 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the MICP fluxes over a face for the TPFA linearizer.
+     *
+     * The water volume flux is given per face area. If the upstream cell of the water
+     * phase is not the interior one, its quantities do not contribute to the
+     * derivatives.
+     */
+    static void computeFlux(RateVector& flux,
+                            const Evaluation& waterVolumeFlux,
+                            const IntensiveQuantities& up,
+                            bool upIsInterior)
+    {
+        if (!enableMICP)
+            return;
+
+        if (upIsInterior) {
+            flux[contiMicrobialEqIdx] = waterVolumeFlux * up.microbialConcentration();
+            flux[contiOxygenEqIdx] = waterVolumeFlux * up.oxygenConcentration();
+            flux[contiUreaEqIdx] = waterVolumeFlux * up.ureaConcentration();
+        }
+        else {
+            flux[contiMicrobialEqIdx] = waterVolumeFlux * decay<Scalar>(up.microbialConcentration());
+            flux[contiOxygenEqIdx] = waterVolumeFlux * decay<Scalar>(up.oxygenConcentration());
+            flux[contiUreaEqIdx] = waterVolumeFlux * decay<Scalar>(up.ureaConcentration());
+        }
+    }
+
     // See https://doi.org/10.1016/j.ijggc.2021.103256 for the micp processes in the model.
     static void addSource(RateVector& source,
                             const ElementContext& elemCtx,
@@ -316,6 +343,23 @@ public:
           dpW = std::max(dpW, abs(waterVolumeVelocity));
         }
 
+        addSource(source, intQuants, dpW);
+    }
+
+    /*!
+     * \brief Add the MICP source terms of a cell.
+     *
+     * dpW is the maximum norm of the pressure gradient of water in the cell center,
+     * i.e., the largest water velocity over the faces of the cell divided by the
+     * permeability and the mobility of water.
+     */
+    static void addSource(RateVector& source,
+                          const IntensiveQuantities& intQuants,
+                          const Evaluation& dpW)
+    {
+        if (!enableMICP)
+            return;
+
         // get the model parameters
         Scalar k_a = microbialAttachmentRate();
         Scalar k_d = microbialDeathRate();
@@ -141,7 +141,7 @@ public:
         ParentType::finishInit();
 
         wasSwitched_.resize(this->model().numTotalDof());
-        std::fill(wasSwitched_.begin(), wasSwitched_.end(), false);
+        std::fill(wasSwitched_.begin(), wasSwitched_.end(), 0);
     }
 
     /*!
@@ -235,6 +235,24 @@ public:
     }
 
 protected:
+    /*!
+     * \copydoc FvBaseNewtonMethod::primaryVariablesChanged_
+     */
+    bool primaryVariablesChanged_(const PrimaryVariables& nextValue,
+                                  const PrimaryVariables& currentValue,
+                                  Scalar tolerance) const
+    {
+        // a switched primary variable always invalidates the intensive quantities
+        if (nextValue.primaryVarsMeaningWater() != currentValue.primaryVarsMeaningWater() ||
+            nextValue.primaryVarsMeaningPressure() != currentValue.primaryVarsMeaningPressure() ||
+            nextValue.primaryVarsMeaningGas() != currentValue.primaryVarsMeaningGas() ||
+            nextValue.primaryVarsMeaningBrine() != currentValue.primaryVarsMeaningBrine() ||
+            nextValue.pvtRegionIndex() != currentValue.pvtRegionIndex())
+            return true;
+
+        return ParentType::primaryVariablesChanged_(nextValue, currentValue, tolerance);
+    }
+
     /*!
      * \copydoc FvBaseNewtonMethod::updatePrimaryVariables_
      */
@@ -420,8 +438,13 @@ protected:
         else
             wasSwitched_[globalDofIdx] = nextValue.adaptPrimaryVariables(this->problem(), globalDofIdx);
 
-        if (wasSwitched_[globalDofIdx])
+        // this method is called concurrently for different degrees of freedom
+        if (wasSwitched_[globalDofIdx]) {
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
             ++ numPriVarsSwitched_;
+        }
         if(projectSaturations_){
             nextValue.chopAndNormalizeSaturations();
         }
@@ -442,7 +465,8 @@ private:
 
     // keep track of cells where the primary variable meaning has changed
     // to detect and hinder oscillations
-    std::vector<bool> wasSwitched_;
+    // not a std::vector<bool> because the entries are written concurrently
+    std::vector<unsigned char> wasSwitched_;
 };
 } // namespace Opm
 
@@ -560,6 +560,72 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the polymer flux over a face for the TPFA linearizer.
+     *
+     * The water volume flux is given per face area and the flux of the water component
+     * must already be contained in the flux vector because it is reduced by the shear
+     * thinning of PLYSHLOG. If the upstream cell of the water phase is not the
+     * interior one, its quantities do not contribute to the derivatives.
+     */
+    template <class ResidualNBInfo>
+    static void computeFlux([[maybe_unused]] RateVector& flux,
+                            [[maybe_unused]] const Evaluation& waterVolumeFlux,
+                            [[maybe_unused]] const IntensiveQuantities& up,
+                            [[maybe_unused]] bool upIsInterior,
+                            [[maybe_unused]] const IntensiveQuantities& intQuantsIn,
+                            [[maybe_unused]] const IntensiveQuantities& intQuantsEx,
+                            [[maybe_unused]] const ResidualNBInfo& nbInfo)
+    {
+        if constexpr (enablePolymer) {
+            const unsigned contiWaterEqIdx = Indices::conti0EqIdx + Indices::canonicalToActiveComponentIndex(FluidSystem::waterCompIdx);
+
+            Evaluation waterShearFactor = 1.0;
+            Evaluation polymerShearFactor = 1.0;
+            if (hasPlyshlog())
+                computeShearFactors_(waterShearFactor,
+                                     polymerShearFactor,
+                                     waterVolumeFlux,
+                                     up,
+                                     intQuantsIn,
+                                     intQuantsEx,
+                                     nbInfo);
+
+            if (upIsInterior) {
+                flux[contiPolymerEqIdx] =
+                        waterVolumeFlux
+                        *up.fluidState().invB(waterPhaseIdx)
+                        *up.polymerViscosityCorrection()
+                        /polymerShearFactor
+                        *up.polymerConcentration();
+
+                // modify water
+                flux[contiWaterEqIdx] /= waterShearFactor;
+            }
+            else {
+                flux[contiPolymerEqIdx] =
+                        waterVolumeFlux
+                        *decay<Scalar>(up.fluidState().invB(waterPhaseIdx))
+                        *decay<Scalar>(up.polymerViscosityCorrection())
+                        /decay<Scalar>(polymerShearFactor)
+                        *decay<Scalar>(up.polymerConcentration());
+
+                // modify water
+                flux[contiWaterEqIdx] /= decay<Scalar>(waterShearFactor);
+            }
+
+            // flux related to transport of polymer molecular weight
+            if constexpr (enablePolymerMolarWeight) {
+                if (upIsInterior)
+                    flux[contiPolymerMolarWeightEqIdx] =
+                        flux[contiPolymerEqIdx]*up.polymerMoleWeight();
+                else
+                    flux[contiPolymerMolarWeightEqIdx] =
+                        flux[contiPolymerEqIdx]*decay<Scalar>(up.polymerMoleWeight());
+            }
+        }
+    }
+
     /*!
      * \brief Return how much a Newton-Raphson update is considered an error
      */
@@ -787,6 +853,53 @@ public:
     }
 
 private:
+    // compute the shear factors of water and polymer from the water velocity over a
+    // face. This is the counterpart of
+    // BlackOilPolymerExtensiveQuantities::updateShearMultipliers() for the TPFA
+    // linearizer.
+    template <class ResidualNBInfo>
+    static void computeShearFactors_(Evaluation& waterShearFactor,
+                                     Evaluation& polymerShearFactor,
+                                     const Evaluation& waterVolumeFlux,
+                                     const IntensiveQuantities& up,
+                                     const IntensiveQuantities& intQuantsIn,
+                                     const IntensiveQuantities& intQuantsEx,
+                                     const ResidualNBInfo& nbInfo)
+    {
+        // compute water velocity from flux
+        Evaluation poroAvg = intQuantsIn.porosity()*0.5 + decay<Scalar>(intQuantsEx.porosity())*0.5;
+        unsigned pvtnumRegionIdx = intQuantsIn.pvtRegionIndex();
+        const Evaluation& Sw = up.fluidState().saturation(waterPhaseIdx);
+
+        // guard against zero porosity and no mobile water
+        Evaluation denom = max(poroAvg * (Sw - nbInfo.Swcr), 1e-12);
+        Evaluation waterVolumeVelocity = waterVolumeFlux / denom;
+
+        // if shrate is specified. Compute shrate based on the water velocity
+        if (hasShrate() && nbInfo.trans > 0.0) {
+            if (nbInfo.dist <= 0.0)
+                throw std::runtime_error("SHRATE requires the distance between the centers of the cells "
+                                         "which was not specified for the face");
+
+            const Evaluation& relWater = up.relativePermeability(waterPhaseIdx);
+            // compute permeability from transmissibility.
+            Scalar absPerm = nbInfo.trans / nbInfo.faceArea * nbInfo.dist;
+            waterVolumeVelocity *=
+                shrate(pvtnumRegionIdx)*sqrt(poroAvg*Sw / (relWater*absPerm));
+            assert(isfinite(waterVolumeVelocity));
+        }
+
+        // compute the shear factors for water and polymer
+        waterShearFactor =
+            computeShearFactor(up.polymerConcentration(),
+                               pvtnumRegionIdx,
+                               waterVolumeVelocity);
+        polymerShearFactor =
+            computeShearFactor(up.polymerConcentration(),
+                               pvtnumRegionIdx,
+                               waterVolumeVelocity*up.polymerViscosityCorrection());
+    }
+
     static BlackOilPolymerParams<Scalar> params_;
 };
 
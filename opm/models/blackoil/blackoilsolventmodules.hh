@@ -459,6 +459,75 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the solvent flux over a face for the TPFA linearizer.
+     *
+     * The solvent flows due to the pressure potential of the gas phase. The flux is
+     * given per face area and only the quantities of the interior cell contribute to
+     * the derivatives.
+     */
+    template <class ResidualNBInfo>
+    static void computeFlux([[maybe_unused]] RateVector& flux,
+                            [[maybe_unused]] const IntensiveQuantities& intQuantsIn,
+                            [[maybe_unused]] const IntensiveQuantities& intQuantsEx,
+                            [[maybe_unused]] const ResidualNBInfo& nbInfo)
+    {
+        if constexpr (enableSolvent) {
+            const Evaluation& rhoIn = intQuantsIn.solventDensity();
+            Scalar rhoEx = decay<Scalar>(intQuantsEx.solventDensity());
+            const Evaluation& rhoAvg = rhoIn*0.5 + rhoEx*0.5;
+
+            const Evaluation& pressureInterior = intQuantsIn.fluidState().pressure(FluidSystem::gasPhaseIdx);
+            Evaluation pressureExterior = decay<Scalar>(intQuantsEx.fluidState().pressure(FluidSystem::gasPhaseIdx));
+            pressureExterior += nbInfo.dZg*rhoAvg;
+
+            Evaluation pressureDiffSolvent = pressureExterior - pressureInterior;
+            if (std::abs(scalarValue(pressureDiffSolvent)) > nbInfo.thpres) {
+                if (pressureDiffSolvent < 0.0)
+                    pressureDiffSolvent += nbInfo.thpres;
+                else
+                    pressureDiffSolvent -= nbInfo.thpres;
+            }
+            else
+                pressureDiffSolvent = 0.0;
+
+            if (pressureDiffSolvent == 0.0) {
+                flux[contiSolventEqIdx] = 0.0;
+                return;
+            }
+
+            if (pressureDiffSolvent < 0.0) {
+                // the interior cell is upstream
+                const Evaluation& solventVolumeFlux =
+                    intQuantsIn.solventMobility()
+                    *(-nbInfo.trans/nbInfo.faceArea)
+                    *pressureDiffSolvent;
+                if constexpr (blackoilConserveSurfaceVolume)
+                    flux[contiSolventEqIdx] =
+                            solventVolumeFlux
+                            *intQuantsIn.solventInverseFormationVolumeFactor();
+                else
+                    flux[contiSolventEqIdx] =
+                            solventVolumeFlux
+                            *intQuantsIn.solventDensity();
+            }
+            else {
+                const Evaluation& solventVolumeFlux =
+                    scalarValue(intQuantsEx.solventMobility())
+                    *(-nbInfo.trans/nbInfo.faceArea)
+                    *pressureDiffSolvent;
+                if constexpr (blackoilConserveSurfaceVolume)
+                    flux[contiSolventEqIdx] =
+                            solventVolumeFlux
+                            *decay<Scalar>(intQuantsEx.solventInverseFormationVolumeFactor());
+                else
+                    flux[contiSolventEqIdx] =
+                            solventVolumeFlux
+                            *decay<Scalar>(intQuantsEx.solventDensity());
+            }
+        }
+    }
+
     /*!
      * \brief Assign the solvent specific primary variables to a PrimaryVariables object
      */
@@ -1145,7 +1214,7 @@ public:
         Valgrind::CheckDefined(solventPGrad);
 
         // correct the pressure gradients by the gravitational acceleration
-        if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity)) {
+        if (elemCtx.problem().enableGravity()) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
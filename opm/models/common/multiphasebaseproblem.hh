@@ -308,6 +308,16 @@ public:
     const DimVector& gravity() const
     { return gravity_; }
 
+    /*!
+     * \brief Returns whether the pressure gradients are corrected by the gravitational
+     *        acceleration.
+     *
+     * This is the value of the <tt>EnableGravity</tt> parameter, which is only read
+     * once when the problem is constructed.
+     */
+    bool enableGravity() const
+    { return enableGravity_; }
+
     /*!
      * \brief Mark grid cells for refinement or coarsening
      *
@@ -383,6 +393,7 @@ protected:
     }
 
     DimVector gravity_;
+    bool enableGravity_;
 
 private:
     //! Returns the implementation of the problem (i.e. static polymorphism)
@@ -394,8 +405,10 @@ private:
 
     void init_()
     {
+        enableGravity_ = EWOMS_GET_PARAM(TypeTag, bool, EnableGravity);
+
         gravity_ = 0.0;
-        if (EWOMS_GET_PARAM(TypeTag, bool, EnableGravity))
+        if (enableGravity_)
             gravity_[dimWorld-1]  = -9.81;
     }
 };
@@ -197,6 +197,43 @@ public:
         }
     }
 
+    /*!
+     * \brief Evaluate the residual of an element without its local Jacobian matrix.
+     *
+     * Since the values of the local residual do not depend on the focus degree of
+     * freedom, the residual is evaluated only once instead of once per primary degree
+     * of freedom, and the derivatives are not extracted. Afterwards, the jacobian()
+     * method must not be used.
+     *
+     * Note that this does not avoid the derivative work itself: The local residual is
+     * still evaluated using the Evaluation type of the type tag, so the derivatives are
+     * computed and then dropped. A scalar instantiation is not possible because the
+     * intensive and extensive quantities of the element context are bound to that type.
+     *
+     * \param elemCtx The element execution context for which the local residual
+     *                should be calculated.
+     */
+    void evalResidual(ElementContext& elemCtx, const Element& elem)
+    {
+        elemCtx.updateStencil(elem);
+        elemCtx.updateAllIntensiveQuantities();
+
+        // update the weights of the primary variables for the context
+        model_().updatePVWeights(elemCtx);
+
+        resize_(elemCtx);
+
+        elemCtx.setFocusDofIndex(/*dofIdx=*/0);
+        elemCtx.updateAllExtensiveQuantities();
+        localResidual_.eval(elemCtx);
+
+        const auto& resid = localResidual_.residual();
+        unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; dofIdx++)
+            for (unsigned eqIdx = 0; eqIdx < numEq; eqIdx++)
+                residual_[dofIdx][eqIdx] = resid[dofIdx][eqIdx].value();
+    }
+
     /*!
      * \brief Return reference to the local residual.
      */
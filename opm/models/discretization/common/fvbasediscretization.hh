@@ -46,12 +46,15 @@
 #include "fvbaseintensivequantities.hh"
 #include "fvbaseextensivequantities.hh"
 #include "baseauxiliarymodule.hh"
+#include "stencilcache.hh"
 
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/simulators/linalg/nullborderlistmanager.hh>
 #include <opm/models/utils/simulator.hh>
 #include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/profiler.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 #include <opm/models/io/vtkprimaryvarsmodule.hh>
@@ -74,6 +77,7 @@
 #include <algorithm>
 #include <limits>
 #include <list>
+#include <memory>
 #include <stdexcept>
 #include <sstream>
 #include <string>
@@ -219,6 +223,8 @@ template<class TypeTag>
 struct ThreadsPerProcess<TypeTag, TTag::FvBaseDiscretization> { static constexpr int value = 1; };
 template<class TypeTag>
 struct UseLinearizationLock<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = true; };
+template<class TypeTag>
+struct EnableColoredLinearization<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
 /*!
  * \brief Linearizer for the global system of equations.
@@ -279,6 +285,22 @@ struct EnableConstraints<TypeTag, TTag::FvBaseDiscretization> { static constexpr
 template<class TypeTag>
 struct EnableIntensiveQuantityCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
 
+// recompute the intensive quantities of all degrees of freedom after each Newton update
+// by default
+template<class TypeTag>
+struct EnableIncrementalIntensiveQuantities<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
+template<class TypeTag>
+struct IntensiveQuantitiesUpdateTolerance<TypeTag, TTag::FvBaseDiscretization>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.0;
+};
+
+// recompute the stencil of each element whenever it is needed by default
+template<class TypeTag>
+struct EnableStencilCache<TypeTag, TTag::FvBaseDiscretization> { static constexpr bool value = false; };
+
 // do not use thermodynamic hints by default. If you enable this, make sure to also
 // enable the intensive quantity cache above to avoid getting an exception...
 template<class TypeTag>
@@ -373,6 +395,7 @@ class FvBaseDiscretization
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementChunks = ThreadedEntityIteratorChunks<GridView, /*codim=*/0>;
 
     using Toolbox = MathToolbox<Evaluation>;
     using VectorBlock = Dune::FieldVector<Evaluation, numEq>;
@@ -463,8 +486,11 @@ public:
 #endif
         , enableGridAdaptation_( EWOMS_GET_PARAM(TypeTag, bool, EnableGridAdaptation) )
         , enableIntensiveQuantityCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantityCache))
+        , enableIncrementalIntensiveQuantities_(EWOMS_GET_PARAM(TypeTag, bool, EnableIncrementalIntensiveQuantities))
+        , intensiveQuantitiesUpdateTolerance_(EWOMS_GET_PARAM(TypeTag, Scalar, IntensiveQuantitiesUpdateTolerance))
         , enableStorageCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache))
         , enableThermodynamicHints_(EWOMS_GET_PARAM(TypeTag, bool, EnableThermodynamicHints))
+        , enableStencilCache_(EWOMS_GET_PARAM(TypeTag, bool, EnableStencilCache))
     {
 #if HAVE_DUNE_FEM
         if (enableGridAdaptation_ && !Dune::Fem::Capabilities::isLocallyAdaptive<Grid>::v)
@@ -532,7 +558,13 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableVtkOutput, "Global switch for turning on writing VTK files");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableThermodynamicHints, "Enable thermodynamic hints");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantityCache, "Turn on caching of intensive quantities");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIncrementalIntensiveQuantities,
+                             "Only recompute the cached intensive quantities of the degrees of freedom changed by the Newton update");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, IntensiveQuantitiesUpdateTolerance,
+                             "The relative change of a primary variable above which its intensive quantities get recomputed");
         EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStorageCache, "Store previous storage terms and avoid re-calculating them.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableStencilCache,
+                             "Store the finite volume stencils of all elements instead of recomputing them for each linearization");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, OutputDir, "The directory to which result files are written");
     }
 
@@ -541,6 +573,17 @@ public:
      */
     void finishInit()
     {
+        // the stencils must be available before the first element context is updated.
+        // since finishInit() is also called after the grid was adapted, this is also
+        // the place where they get recomputed.
+        if (enableStencilCache_) {
+            if (!stencilCache_)
+                stencilCache_ = std::make_unique<StencilCacheType>(gridView_,
+                                                                   asImp_().dofMapper(),
+                                                                   elementMapper_);
+            stencilCache_->update(simulator_.vanguard().gridSequenceNumber(), elementChunks());
+        }
+
         // initialize the volume of the finite volumes to zero
         size_t numDof = asImp_().numGridDof();
         dofTotalVolume_.resize(numDof);
@@ -735,6 +778,33 @@ public:
         return &intensiveQuantityCache_[timeIdx][globalIdx];
     }
 
+    /*!
+     * \brief Return the stored finite volume stencil of an element.
+     *
+     * \attention If the stencil cache is disabled, this method will return 0.
+     *
+     * \param elem The element for which the stencil is requested.
+     */
+    const Stencil* cachedStencil(const Element& elem) const
+    {
+        if (!stencilCache_)
+            return 0;
+
+        return &stencilCache_->get(elem);
+    }
+
+    /*!
+     * \brief Return the chunks of elements used by the threaded loops over the grid.
+     *
+     * The chunks are only recomputed if the grid or the number of threads has
+     * changed. This method must be called in a sequential context.
+     */
+    const ElementChunks& elementChunks() const
+    {
+        elementChunks_.update(gridView_, simulator_.vanguard().gridSequenceNumber());
+        return elementChunks_;
+    }
+
     /*!
      * \brief Update the intensive quantity cache for a entity on the grid at given time.
      *
@@ -752,6 +822,26 @@ public:
 
         intensiveQuantityCache_[timeIdx][globalIdx] = intQuants;
         intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = 1;
+
+        // the intensive quantities are always computed from the current solution.
+        // remember its primary variables to decide about the validity of the cache
+        // entry after the next Newton update
+        if (timeIdx == 0 && enableIncrementalIntensiveQuantities())
+            intensiveQuantityCachePrimaryVars_[globalIdx] = solution(/*timeIdx=*/0)[globalIdx];
+    }
+
+    /*!
+     * \brief Return the primary variables from which the cached intensive quantities of
+     *        a degree of freedom for the most recent time index were computed.
+     *
+     * This is only available if the intensive quantities are updated incrementally.
+     *
+     * \param globalIdx The global space index of the degree of freedom
+     */
+    const PrimaryVariables& cachedIntensiveQuantitiesPrimaryVars(unsigned globalIdx) const
+    {
+        assert(enableIncrementalIntensiveQuantities());
+        return intensiveQuantityCachePrimaryVars_[globalIdx];
     }
 
     /*!
@@ -785,14 +875,32 @@ public:
         }
     }
 
+    /*!
+     * \brief Recompute the intensive quantities of all degrees of freedom.
+     *
+     * If the intensive quantities are updated incrementally, the cache entries which
+     * are still valid for the most recent time index are kept, i.e., only the
+     * quantities of the degrees of freedom invalidated by the Newton update are
+     * recomputed. Since the intensive quantities of a degree of freedom only depend on
+     * its own primary variables, the dependents of a changed degree of freedom do not
+     * need to be updated; only their fluxes change, and these are always re-evaluated
+     * by the linearizer.
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
     void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx) const
     {
-        invalidateIntensiveQuantitiesCache(timeIdx);
+        const bool incremental = enableIncrementalIntensiveQuantities() && timeIdx == 0;
+        if (!incremental)
+            invalidateIntensiveQuantitiesCache(timeIdx);
+
+        long numSkipped = 0;
+        long numVisited = 0;
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_, elementChunks());
 #ifdef _OPENMP
-#pragma omp parallel
+#pragma omp parallel reduction(+:numSkipped, numVisited)
 #endif
         {
             ElementContext elemCtx(simulator_);
@@ -800,9 +908,48 @@ public:
             for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
                 const Element& elem = *elemIt;
                 elemCtx.updatePrimaryStencil(elem);
+
+                if (incremental) {
+                    bool upToDate = true;
+                    const std::size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned dofIdx = 0; dofIdx < numPrimaryDof && upToDate; ++dofIdx) {
+                        const unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                        upToDate = intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] != 0;
+                    }
+
+                    numVisited += static_cast<long>(numPrimaryDof);
+                    if (upToDate) {
+                        numSkipped += static_cast<long>(numPrimaryDof);
+                        continue;
+                    }
+                }
+
                 elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
             }
         }
+
+        if (incremental) {
+            EWOMS_PROFILE_COUNT("intensive_quantities_skipped", numSkipped);
+            numIntensiveQuantitiesSkipped_ = numSkipped;
+            numIntensiveQuantitiesVisited_ = numVisited;
+        }
+    }
+
+    /*!
+     * \brief Returns how many intensive quantity updates were skipped by the last
+     *        incremental update of the cache on the local process.
+     *
+     * The intensive quantities are updated per element, so the primary degrees of
+     * freedom of all elements are counted, i.e., degrees of freedom which are shared
+     * by several elements are counted multiple times.
+     *
+     * \param numSkipped The number of skipped degrees of freedom
+     * \param numVisited The total number of considered degrees of freedom
+     */
+    void intensiveQuantitiesSkipStatistics(long& numSkipped, long& numVisited) const
+    {
+        numSkipped = numIntensiveQuantitiesSkipped_;
+        numVisited = numIntensiveQuantitiesVisited_;
     }
 
     /*!
@@ -916,7 +1063,7 @@ public:
         dest = 0;
 
         std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_, elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -977,7 +1124,7 @@ public:
         storage = 0;
 
         std::mutex mutex;
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView(), elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1297,6 +1444,13 @@ public:
         solveTimer_.halt();
         updateTimer_.halt();
 
+        // the intensive quantities may depend on state which the problem modifies at
+        // the beginning of a time step (e.g., hysteresis or rock compaction), so the
+        // cached ones of the last time step must not be reused even if they are
+        // updated incrementally
+        if (enableIncrementalIntensiveQuantities())
+            invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
+
         prePostProcessTimer_.start();
         asImp_().updateBegin();
         prePostProcessTimer_.stop();
@@ -1437,6 +1591,9 @@ public:
         // previous time step so that we can start the next
         // update at a physically meaningful solution.
         solution(/*timeIdx=*/0) = solution(/*timeIdx=*/1);
+        // the solution has been replaced as a whole, so none of the cached intensive
+        // quantities may be reused, even if they are updated incrementally
+        invalidateIntensiveQuantitiesCache(/*timeIdx=*/0);
         invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
 
 #ifndef NDEBUG
@@ -1754,7 +1911,7 @@ public:
         }
 
         // iterate over grid
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView(), elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -1869,6 +2026,21 @@ public:
     bool storeIntensiveQuantities() const
     { return enableIntensiveQuantityCache_ || enableThermodynamicHints_; }
 
+    /*!
+     * \brief Returns true if the Newton method only invalidates the cached intensive
+     *        quantities of the degrees of freedom which it changed.
+     */
+    bool enableIncrementalIntensiveQuantities() const
+    { return enableIntensiveQuantityCache_ && enableIncrementalIntensiveQuantities_; }
+
+    /*!
+     * \brief Returns the relative change of a primary variable above which the
+     *        intensive quantities of a degree of freedom get recomputed in the
+     *        incremental mode.
+     */
+    Scalar intensiveQuantitiesUpdateTolerance() const
+    { return intensiveQuantitiesUpdateTolerance_; }
+
 #if HAVE_DUNE_FEM
     AdaptationManager& adaptationManager()
     {
@@ -1938,6 +2110,9 @@ protected:
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof);
                 invalidateIntensiveQuantitiesCache(timeIdx);
             }
+
+            if (enableIncrementalIntensiveQuantities())
+                intensiveQuantityCachePrimaryVars_.resize(numDof);
         }
     }
     template <class Context>
@@ -2030,8 +2205,22 @@ protected:
 
     bool enableGridAdaptation_;
     bool enableIntensiveQuantityCache_;
+    bool enableIncrementalIntensiveQuantities_;
+    Scalar intensiveQuantitiesUpdateTolerance_;
+    // the primary variables from which the cached intensive quantities of the most
+    // recent time index were computed. only used for the incremental update
+    mutable std::vector<PrimaryVariables> intensiveQuantityCachePrimaryVars_;
+    mutable long numIntensiveQuantitiesSkipped_ = 0;
+    mutable long numIntensiveQuantitiesVisited_ = 0;
     bool enableStorageCache_;
     bool enableThermodynamicHints_;
+
+    using StencilCacheType = StencilCache<GridView, Stencil, DofMapper, ElementMapper>;
+    std::unique_ptr<StencilCacheType> stencilCache_;
+    bool enableStencilCache_;
+
+    // the chunks of elements for the threaded loops over the grid
+    mutable ElementChunks elementChunks_;
 };
 } // namespace Opm
 
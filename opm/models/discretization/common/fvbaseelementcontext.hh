@@ -95,6 +95,7 @@ public:
     {
         // remember the simulator object
         simulatorPtr_ = &simulator;
+        stencilPtr_ = &stencil_;
         enableStorageCache_ = EWOMS_GET_PARAM(TypeTag, bool, EnableStorageCache);
         stashedDofIdx_ = -1;
         focusDofIdx_ = -1;
@@ -134,11 +135,14 @@ public:
         // update the stencil. the center gradients are quite expensive to calculate and
         // most models don't need them, so that we only do this if the model explicitly
         // enables them
-        stencil_.update(elem);
+        if (!useCachedStencil_(elem)) {
+            stencil_.update(elem);
+            stencilPtr_ = &stencil_;
+        }
 
         // resize the arrays containing the flux and the volume variables
-        dofVars_.resize(stencil_.numDof());
-        extensiveQuantities_.resize(stencil_.numInteriorFaces());
+        dofVars_.resize(stencilPtr_->numDof());
+        extensiveQuantities_.resize(stencilPtr_->numInteriorFaces());
     }
 
     /*!
@@ -153,9 +157,12 @@ public:
         elemPtr_ = &elem;
 
         // update the finite element geometry
-        stencil_.updatePrimaryTopology(elem);
+        if (!useCachedStencil_(elem)) {
+            stencil_.updatePrimaryTopology(elem);
+            stencilPtr_ = &stencil_;
+        }
 
-        dofVars_.resize(stencil_.numPrimaryDof());
+        dofVars_.resize(stencilPtr_->numPrimaryDof());
     }
 
     /*!
@@ -170,7 +177,10 @@ public:
         elemPtr_ = &elem;
 
         // update the finite element geometry
-        stencil_.updateTopology(elem);
+        if (!useCachedStencil_(elem)) {
+            stencil_.updateTopology(elem);
+            stencilPtr_ = &stencil_;
+        }
     }
 
     /*!
@@ -248,6 +258,25 @@ public:
         }
     }
 
+    /*!
+     * \brief Compute the extensive quantities of a single sub-control volume face of
+     *        the current element.
+     *
+     * In contrast to updateExtensiveQuantities(), the gradient calculator is not
+     * prepared, i.e., this must either have been done before or the gradient calculator
+     * must not need any preparation.
+     *
+     * \param fluxIdx The local index of the sub-control volume face
+     * \param timeIdx The index of the solution vector used by the
+     *                time discretization.
+     */
+    void updateFaceExtensiveQuantities(unsigned fluxIdx, unsigned timeIdx)
+    {
+        extensiveQuantities_[fluxIdx].update(/*context=*/asImp_(),
+                                             /*localIndex=*/fluxIdx,
+                                             timeIdx);
+    }
+
     /*!
      * \brief Sets the degree of freedom on which the simulator is currently "focused" on
      *
@@ -337,7 +366,7 @@ public:
      *                time discretization.
      */
     const Stencil& stencil(unsigned) const
-    { return stencil_; }
+    { return *stencilPtr_; }
 
     /*!
      * \brief Return the position of a local entities in global coordinates
@@ -348,7 +377,7 @@ public:
      *                time discretization.
      */
     const GlobalPosition& pos(unsigned dofIdx, unsigned) const
-    { return stencil_.subControlVolume(dofIdx).globalPos(); }
+    { return stencilPtr_->subControlVolume(dofIdx).globalPos(); }
 
     /*!
      * \brief Return the global spatial index for a sub-control volume
@@ -531,6 +560,18 @@ public:
     { enableStorageCache_ = yesno; }
 
 private:
+    // use the stencil stored by the model if it is available. the cached stencils are
+    // complete, so they can also be used if only the topology is requested.
+    bool useCachedStencil_(const Element& elem)
+    {
+        const Stencil* cachedStencil = model().cachedStencil(elem);
+        if (!cachedStencil)
+            return false;
+
+        stencilPtr_ = cachedStencil;
+        return true;
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
@@ -594,6 +635,7 @@ protected:
     const Element *elemPtr_;
     const GridView gridView_;
     Stencil stencil_;
+    const Stencil* stencilPtr_;
 
     int stashedDofIdx_;
     int focusDofIdx_;
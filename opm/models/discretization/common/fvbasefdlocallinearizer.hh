@@ -62,6 +62,8 @@ template<class TypeTag, class MyTypeTag>
 struct NumericDifferenceMethod { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct BaseEpsilon { using type = UndefinedProperty; };
+template<class TypeTag, class MyTypeTag>
+struct EnableLocalizedFiniteDifferences { using type = UndefinedProperty; };
 
 // set the properties to be spliced in
 template<class TypeTag>
@@ -82,6 +84,16 @@ struct Evaluation<TypeTag, TTag::FiniteDifferenceLocalLinearizer>
 template<class TypeTag>
 struct NumericDifferenceMethod<TypeTag, TTag::FiniteDifferenceLocalLinearizer> { static constexpr int value = +1; };
 
+/*!
+ * \brief Specify whether only the terms of the residual which depend on the deflected
+ *        degree of freedom are re-evaluated.
+ *
+ * This is only used if the local residual supports it, see
+ * FvBaseLocalResidual::supportsLocalizedEval().
+ */
+template<class TypeTag>
+struct EnableLocalizedFiniteDifferences<TypeTag, TTag::FiniteDifferenceLocalLinearizer> { static constexpr bool value = false; };
+
 //! The base epsilon value for finite difference calculations
 template<class TypeTag>
 struct BaseEpsilon<TypeTag, TTag::FiniteDifferenceLocalLinearizer>
@@ -129,6 +141,14 @@ namespace Opm {
  * Here, \f$ f \f$ is the residual function for all equations, \f$x\f$ is the value of a
  * sub-control volume's primary variable at the evaluation point and \f$\epsilon\f$ is a
  * small scalar value larger than 0.
+ *
+ * If the "EnableLocalizedFiniteDifferences" parameter is set and the local residual
+ * supports it, a deflection of the primary variables of a degree of freedom only
+ * triggers the re-evaluation of the fluxes over the faces adjacent to it and of its
+ * volume and boundary terms instead of the full residual of the element. This is exact
+ * if the fluxes are computed using two-point approximations and it pays off if the
+ * degrees of freedom are only adjacent to a few faces of an element, e.g., for the
+ * vertex-centered finite volume discretization.
  */
 template<class TypeTag>
 class FvBaseFdLocalLinearizer
@@ -185,6 +205,9 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, int, NumericDifferenceMethod,
                              "The method used for numeric differentiation (-1: backward "
                              "differences, 0: central differences, 1: forward differences)");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableLocalizedFiniteDifferences,
+                             "Only re-evaluate the terms of the residual which depend on the "
+                             "deflected degree of freedom if the local residual supports this");
     }
 
     /*!
@@ -200,6 +223,13 @@ public:
         simulatorPtr_ = &simulator;
         delete internalElemContext_;
         internalElemContext_ = new ElementContext(simulator);
+
+        // the parameters are only read once because they are required for each
+        // deflection of a primary variable
+        differenceMethod_ = EWOMS_GET_PARAM(TypeTag, int, NumericDifferenceMethod);
+        localized_ =
+            LocalResidual::supportsLocalizedEval()
+            && EWOMS_GET_PARAM(TypeTag, bool, EnableLocalizedFiniteDifferences);
     }
 
     /*!
@@ -257,6 +287,28 @@ public:
         }
     }
 
+    /*!
+     * \brief Evaluate the residual of an element without its local Jacobian matrix.
+     *
+     * This skips all deflections of the primary variables. Afterwards, the jacobian()
+     * method must not be used.
+     *
+     * \param elemCtx The element execution context for which the local residual
+     *                should be calculated.
+     */
+    void evalResidual(ElementContext& elemCtx, const Element& elem)
+    {
+        elemCtx.updateAll(elem);
+
+        // update the weights of the primary variables for the context
+        model_().updatePVWeights(elemCtx);
+
+        resize_(elemCtx);
+        reset_(elemCtx);
+
+        localResidual_.eval(residual_, elemCtx);
+    }
+
     /*!
      * \brief Returns the unweighted epsilon value used to calculate
      *        the local derivatives
@@ -334,8 +386,8 @@ protected:
     /*!
      * \brief Returns the numeric difference method which is applied.
      */
-    static int numericDifferenceMethod_()
-    { return EWOMS_GET_PARAM(TypeTag, int, NumericDifferenceMethod); }
+    int numericDifferenceMethod_() const
+    { return differenceMethod_; }
 
     /*!
      * \brief Resize all internal attributes to the size of the
@@ -350,6 +402,10 @@ protected:
         jacobian_.setSize(numDof, numPrimaryDof);
 
         derivResidual_.resize(numDof);
+        if (localized_) {
+            localizedResidual_.resize(numDof);
+            deflectedResidual_.resize(numDof);
+        }
     }
 
     /*!
@@ -421,6 +477,14 @@ protected:
         Scalar eps = asImp_().numericEpsilon(elemCtx, dofIdx, pvIdx);
         Scalar delta = 0.0;
 
+        // if only the terms which depend on the deflected degree of freedom are
+        // evaluated, the residual of the undeflected solution must be restricted to the
+        // same terms. it is the same for all primary variables of the degree of freedom.
+        if (localized_ && numericDifferenceMethod_() != 0 && pvIdx == 0)
+            evalLocalizedResidual_(localizedResidual_, elemCtx, dofIdx);
+        const LocalEvalBlockVector& undeflectedResidual =
+            localized_ ? localizedResidual_ : residual_;
+
         if (numericDifferenceMethod_() >= 0) {
             // we are not using backward differences, i.e. we need to
             // calculate f(x + \epsilon)
@@ -431,14 +495,18 @@ protected:
 
             // calculate the deflected residual
             elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-            elemCtx.updateAllExtensiveQuantities();
-            localResidual_.eval(derivResidual_, elemCtx);
+            if (localized_)
+                evalLocalizedResidual_(derivResidual_, elemCtx, dofIdx);
+            else {
+                elemCtx.updateAllExtensiveQuantities();
+                localResidual_.eval(derivResidual_, elemCtx);
+            }
         }
         else {
             // we are using backward differences, i.e. we don't need
             // to calculate f(x + \epsilon) and we can recycle the
             // (already calculated) residual f(x)
-            derivResidual_ = residual_;
+            derivResidual_ = undeflectedResidual;
         }
 
         if (numericDifferenceMethod_() <= 0) {
@@ -452,16 +520,22 @@ protected:
             // calculate the deflected residual again, this time we use the local
             // residual's internal storage.
             elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-            elemCtx.updateAllExtensiveQuantities();
-            localResidual_.eval(elemCtx);
+            if (localized_) {
+                evalLocalizedResidual_(deflectedResidual_, elemCtx, dofIdx);
+                derivResidual_ -= deflectedResidual_;
+            }
+            else {
+                elemCtx.updateAllExtensiveQuantities();
+                localResidual_.eval(elemCtx);
 
-            derivResidual_ -= localResidual_.residual();
+                derivResidual_ -= localResidual_.residual();
+            }
         }
         else {
             // we are using forward differences, i.e. we don't need to
             // calculate f(x - \epsilon) and we can recycle the
             // (already calculated) residual f(x)
-            derivResidual_ -= residual_;
+            derivResidual_ -= undeflectedResidual;
         }
 
         assert(delta > 0);
@@ -480,6 +554,29 @@ protected:
 #endif
     }
 
+    /*!
+     * \brief Evaluate the terms of the residual which depend on the primary variables of
+     *        a degree of freedom.
+     *
+     * The extensive quantities of the faces adjacent to the degree of freedom are
+     * updated before. Those of the other faces are left alone, i.e., they may be
+     * outdated afterwards.
+     */
+    void evalLocalizedResidual_(LocalEvalBlockVector& result,
+                                ElementContext& elemCtx,
+                                unsigned dofIdx)
+    {
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        size_t numInteriorFaces = elemCtx.numInteriorFaces(/*timeIdx=*/0);
+        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; ++scvfIdx) {
+            const auto& face = stencil.interiorFace(scvfIdx);
+            if (face.interiorIndex() == dofIdx || face.exteriorIndex() == dofIdx)
+                elemCtx.updateFaceExtensiveQuantities(scvfIdx, /*timeIdx=*/0);
+        }
+
+        localResidual_.evalLocalized(result, elemCtx, dofIdx);
+    }
+
     /*!
      * \brief Updates the current local Jacobian matrix with the partial derivatives of
      *        all equations for primary variable 'pvIdx' at the degree of freedom
@@ -509,8 +606,13 @@ protected:
 
     LocalEvalBlockVector residual_;
     LocalEvalBlockVector derivResidual_;
+    LocalEvalBlockVector localizedResidual_;
+    LocalEvalBlockVector deflectedResidual_;
     ScalarLocalBlockMatrix jacobian_;
 
+    int differenceMethod_ = +1;
+    bool localized_ = false;
+
     LocalResidual localResidual_;
 };
 
@@ -69,6 +69,13 @@ public:
     static void registerParameters()
     { }
 
+    /*!
+     * \brief Returns true if the values and gradients at a flux approximation point
+     *        only depend on the two degrees of freedom adjacent to it.
+     */
+    static constexpr bool usesTwoPointApproximation()
+    { return true; }
+
     /*!
      * \brief Precomputes the common values to calculate gradients and values of
      *        quantities at every interior flux approximation point.
@@ -38,17 +38,21 @@
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/utils/profiler.hh>
+#include <opm/simulators/linalg/csrsparsitypattern.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
 #include <type_traits>
+#include <cstdint>
 #include <iostream>
 #include <vector>
 #include <thread>
 #include <set>
 #include <exception>   // current_exception, rethrow_exception
+#include <limits>
 #include <mutex>
 
 namespace Opm {
@@ -94,6 +98,7 @@ class FvBaseLinearizer
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
+    using ElementSeed = typename Element::EntitySeed;
 
     using Vector = GlobalEqVector;
 
@@ -116,6 +121,7 @@ public:
         : jacobian_()
     {
         simulatorPtr_ = 0;
+        enableColoredLinearization_ = EWOMS_GET_PARAM(TypeTag, bool, EnableColoredLinearization);
     }
 
     ~FvBaseLinearizer()
@@ -130,7 +136,11 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableColoredLinearization,
+                             "Linearize groups of elements which do not share degrees of freedom "
+                             "in parallel instead of locking the global system of equations");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -151,6 +161,7 @@ public:
             delete *it;
         }
         elementCtx_.resize(0);
+        elementColorSeqNum_ = -1;
     }
 
     /*!
@@ -191,37 +202,26 @@ public:
      * represented by the model object.
      */
     void linearizeDomain()
-    {
-        // we defer the initialization of the Jacobian matrix until here because the
-        // auxiliary modules usually assume the problem, model and grid to be fully
-        // initialized...
-        if (!jacobian_)
-            initFirstIteration_();
+    { linearizeDomain_(/*residualOnly=*/false); }
 
-        int succeeded;
-        try {
-            linearize_();
-            succeeded = 1;
-        }
-        catch (const std::exception& e)
-        {
-            std::cout << "rank " << simulator_().gridView().comm().rank()
-                      << " caught an exception while linearizing:" << e.what()
-                      << "\n"  << std::flush;
-            succeeded = 0;
-        }
-        catch (...)
-        {
-            std::cout << "rank " << simulator_().gridView().comm().rank()
-                      << " caught an exception while linearizing"
-                      << "\n"  << std::flush;
-            succeeded = 0;
-        }
-        succeeded = gridView_().comm().min(succeeded);
+    /*!
+     * \brief Evaluate the residual of the spatial domain but keep the Jacobian matrix
+     *        of the most recent linearization.
+     *
+     * This is used by Newton iterations which reuse the Jacobian matrix of a previous
+     * iteration. The local Jacobian matrices are neither computed nor assembled.
+     */
+    void linearizeDomainResidual()
+    { linearizeDomain_(/*residualOnly=*/true); }
 
-        if (!succeeded)
-            throw NumericalProblem("A process did not succeed in linearizing the system");
-    }
+    /*!
+     * \brief Returns true if linearizeDomainResidual() can be used.
+     *
+     * Auxiliary modules always add their contributions to the Jacobian matrix, so
+     * keeping it across linearizations is not possible if there are any.
+     */
+    bool supportsResidualOnlyLinearization() const
+    { return jacobian_ && model_().numAuxiliaryModules() == 0; }
 
     void finalize()
     { jacobian_->finalize(); }
@@ -296,6 +296,13 @@ public:
     const std::map<unsigned, Constraints>& constraintsMap() const
     { return constraintsMap_; }
 
+    /*!
+     * \brief Returns a number which changes whenever the map of the constraint degrees
+     *        of freedom is rebuilt.
+     */
+    unsigned constraintsMapVersion() const
+    { return constraintsMapVersion_; }
+
     /*!
      * \brief Return constant reference to the flowsInfo.
      *
@@ -355,46 +362,137 @@ private:
     // Construct the BCRS matrix for the Jacobian of the residual function
     void createMatrix_()
     {
+        EWOMS_PROFILE_SCOPE("create_matrix");
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
+        const std::size_t numDof = model.numTotalDof();
+
+        // the auxiliary equations specify their additional neighbors and degrees of
+        // freedom as a set per row. since they only affect a few rows, this is cheap
+        // compared to doing the same for the main model.
+        std::vector<std::set<unsigned>> auxSparsityPattern;
+        const size_t numAuxMod = model.numAuxiliaryModules();
+        if (numAuxMod > 0) {
+            auxSparsityPattern.resize(numDof);
+            for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+                model.auxiliaryModule(auxModIdx)->addNeighbors(auxSparsityPattern);
+        }
+
+        // for the main model, each primary degree of freedom is coupled to all degrees
+        // of freedom of the stencils it is part of. first count these couplings, then
+        // add them to the pattern.
+        Linear::CsrSparsityPattern sparsityPattern;
+        sparsityPattern.beginCount(numDof);
+        forEachStencil_([&sparsityPattern](const Stencil& stencil) {
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx)
+                sparsityPattern.count(stencil.globalSpaceIndex(primaryDofIdx), stencil.numDof());
+        });
+        if (numAuxMod > 0)
+            sparsityPattern.count(auxSparsityPattern);
+
+        sparsityPattern.beginFill();
+        forEachStencil_([&sparsityPattern](const Stencil& stencil) {
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx)
+                    sparsityPattern.add(myIdx, stencil.globalSpaceIndex(dofIdx));
+            }
+        });
+        if (numAuxMod > 0)
+            sparsityPattern.add(auxSparsityPattern);
+
+        sparsityPattern.finalize();
+
+        // allocate raw matrix
+        jacobian_.reset(new SparseMatrixAdapter(simulator_()));
+
+        // create matrix structure based on sparsity pattern
+        jacobian_->reserve(sparsityPattern);
 
-        // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        using NeighborSet = std::set< unsigned >;
-        std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
+        updateBlockAddresses_();
+    }
+
+    // determine the addresses of the matrix blocks to which the local Jacobians of each
+    // element are added. they stay valid as long as the matrix is not recreated, so
+    // the linearization does not need to look up the column of each block.
+    void updateBlockAddresses_()
+    {
+        EWOMS_PROFILE_SCOPE("update_block_addresses");
+        elementBlockOffsets_.resize(elementMapper_().size());
+        elementBlockAddresses_.clear();
 
+        Stencil stencil(gridView_(), model_().dofMapper());
         for (const auto& elem : elements(gridView_())) {
             stencil.update(elem);
-
+            elementBlockOffsets_[elementMapper_().index(elem)] = elementBlockAddresses_.size();
             for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
-                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
-
+                unsigned globI = stencil.globalSpaceIndex(primaryDofIdx);
                 for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
+                    unsigned globJ = stencil.globalSpaceIndex(dofIdx);
+                    elementBlockAddresses_.push_back(jacobian_->blockAddress(globJ, globI));
                 }
             }
         }
+    }
 
-        // add the additional neighbors and degrees of freedom caused by the auxiliary
-        // equations
-        size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+    // call a functor for the stencil of each element of the grid. the elements are
+    // processed concurrently, so the functor must be thread safe.
+    template <class Functor>
+    void forEachStencil_(const Functor& functor) const
+    {
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_(), model_().elementChunks());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Stencil stencil(gridView_(), model_().dofMapper());
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                stencil.update(*elemIt);
+                functor(stencil);
+            }
+        }
+    }
 
-        // allocate raw matrix
-        jacobian_.reset(new SparseMatrixAdapter(simulator_()));
+    void linearizeDomain_(bool residualOnly)
+    {
+        // we defer the initialization of the Jacobian matrix until here because the
+        // auxiliary modules usually assume the problem, model and grid to be fully
+        // initialized...
+        if (!jacobian_)
+            initFirstIteration_();
 
-        // create matrix structure based on sparsity pattern
-        jacobian_->reserve(sparsityPattern);
+        int succeeded;
+        try {
+            linearize_(residualOnly);
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while linearizing:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while linearizing"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = gridView_().comm().min(succeeded);
+
+        if (!succeeded)
+            throw NumericalProblem("A process did not succeed in linearizing the system");
     }
 
     // reset the global linear system of equations.
-    void resetSystem_()
+    void resetSystem_(bool residualOnly = false)
     {
         residual_ = 0.0;
         // zero all matrix entries
-        jacobian_->clear();
+        if (!residualOnly)
+            jacobian_->clear();
     }
 
     // query the problem for all constraint degrees of freedom. note that this method is
@@ -408,7 +506,7 @@ private:
         constraintsMap_.clear();
 
         // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_(), model_().elementChunks());
 #ifdef _OPENMP
 #pragma omp parallel
 #endif
@@ -441,12 +539,132 @@ private:
                 }
             }
         }
+
+        ++ constraintsMapVersion_;
+    }
+
+    // group the elements into colors such that no two elements of the same color share
+    // a primary degree of freedom.
+    //
+    // The contributions of an element are only added to the residual of its primary
+    // DOFs and to the matrix columns of its primary DOFs, so the elements of a color can
+    // be linearized concurrently without any locking.
+    void updateElementColors_()
+    {
+        int curSeqNum = simulator_().vanguard().gridSequenceNumber();
+        if (elementColorSeqNum_ == curSeqNum)
+            // the grid did not change since the colors have been computed
+            return;
+
+        elementColorSeqNum_ = curSeqNum;
+
+        // collect the seeds and the primary DOFs of the elements which we need to
+        // linearize
+        std::vector<ElementSeed> seeds;
+        std::vector<unsigned> primaryDofOffsets(1, 0);
+        std::vector<unsigned> primaryDofs;
+        Stencil stencil(gridView_(), model_().dofMapper());
+        for (const auto& elem : elements(gridView_())) {
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            stencil.update(elem);
+            seeds.push_back(elem.seed());
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx)
+                primaryDofs.push_back(stencil.globalSpaceIndex(primaryDofIdx));
+            primaryDofOffsets.push_back(primaryDofs.size());
+        }
+
+        // greedy coloring: each sweep over the remaining elements creates one color
+        const unsigned invalidColor = std::numeric_limits<unsigned>::max();
+        std::vector<unsigned> dofColor(model_().numTotalDof(), invalidColor);
+        std::vector<bool> isColored(seeds.size(), false);
+        std::size_t numColored = 0;
+        elementColorSeeds_.clear();
+        elementColorSeeds_.reserve(seeds.size());
+        elementColorOffsets_.assign(1, 0);
+        for (unsigned color = 0; numColored < seeds.size(); ++color) {
+            for (std::size_t elemIdx = 0; elemIdx < seeds.size(); ++elemIdx) {
+                if (isColored[elemIdx])
+                    continue;
+
+                bool conflict = false;
+                for (unsigned i = primaryDofOffsets[elemIdx]; i < primaryDofOffsets[elemIdx + 1]; ++i) {
+                    if (dofColor[primaryDofs[i]] == color) {
+                        conflict = true;
+                        break;
+                    }
+                }
+                if (conflict)
+                    continue;
+
+                for (unsigned i = primaryDofOffsets[elemIdx]; i < primaryDofOffsets[elemIdx + 1]; ++i)
+                    dofColor[primaryDofs[i]] = color;
+                isColored[elemIdx] = true;
+                elementColorSeeds_.push_back(seeds[elemIdx]);
+                ++numColored;
+            }
+            elementColorOffsets_.push_back(elementColorSeeds_.size());
+        }
+    }
+
+    // linearize all elements one color after the other without locking the global
+    // system of equations
+    void linearizeColored_(bool residualOnly)
+    {
+        updateElementColors_();
+
+        // storage to any exception that needs to be bridged out of the
+        // parallel block below. initialized to null to indicate no exception
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        EWOMS_PROFILE_SCOPE("linearize_elements");
+        std::uint64_t numElements = 0;
+        std::uint64_t numFaces = 0;
+
+        const auto& grid = gridView_().grid();
+        const std::size_t numColors = elementColorOffsets_.size() - 1;
+        for (std::size_t color = 0; color < numColors && !exceptionPtr; ++color) {
+            const long beginIdx = elementColorOffsets_[color];
+            const long endIdx = elementColorOffsets_[color + 1];
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:numElements,numFaces)
+#endif
+            for (long elemIdx = beginIdx; elemIdx < endIdx; ++elemIdx) {
+                try {
+                    const Element elem = grid.entity(elementColorSeeds_[elemIdx]);
+                    numFaces += linearizeElement_(elem, residualOnly);
+                    ++ numElements;
+                }
+                // exceptions must not escape the parallel block, see linearize_()
+                catch(...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                }
+            }
+        }
+
+        flushLocalResidualProfiles_();
+        EWOMS_PROFILE_COUNT("elements", numElements);
+        EWOMS_PROFILE_COUNT("faces", numFaces);
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    // add the time which the local residuals of all threads spent in the flux, storage,
+    // source and boundary terms to the profile of the current scope
+    void flushLocalResidualProfiles_()
+    {
+        for (unsigned threadId = 0; threadId < ThreadManager::maxThreads(); ++threadId)
+            model_().localResidual(threadId).flushProfile();
     }
 
     // linearize the whole system
-    void linearize_()
+    void linearize_(bool residualOnly)
     {
-        resetSystem_();
+        resetSystem_(residualOnly);
 
         // before the first iteration of each time step, we need to update the
         // constraints. (i.e., we assume that constraints can be time dependent, but they
@@ -456,6 +674,12 @@ private:
 
         applyConstraintsToSolution_();
 
+        if (useColoredLinearization_()) {
+            linearizeColored_(residualOnly);
+            applyConstraintsToLinearization_(residualOnly);
+            return;
+        }
+
         // to avoid a race condition if two threads handle an exception at the same time,
         // we use an explicit lock to control access to the exception storage object
         // amongst thread-local handlers
@@ -465,10 +689,18 @@ private:
         // parallel block below. initialized to null to indicate no exception
         std::exception_ptr exceptionPtr = nullptr;
 
+        // the profile is recorded for the whole loop instead of each element because
+        // the overhead of the timers would be significant compared to the work done
+        // for a single element. the local residuals only accumulate the time of their
+        // terms, which is added to the profile after the loop.
+        EWOMS_PROFILE_SCOPE("linearize_elements");
+        std::uint64_t numElements = 0;
+        std::uint64_t numFaces = 0;
+
         // relinearize the elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_(), model_().elementChunks());
 #ifdef _OPENMP
-#pragma omp parallel
+#pragma omp parallel reduction(+:numElements,numFaces)
 #endif
         {
             ElementIterator elemIt = threadedElemIt.beginParallel();
@@ -492,7 +724,8 @@ private:
                     if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
                         continue;
 
-                    linearizeElement_(elem);
+                    numFaces += linearizeElement_(elem, residualOnly);
+                    ++ numElements;
                 }
             }
             // If an exception occurs in the parallel block, it won't escape the
@@ -511,6 +744,10 @@ private:
             }
         }  // parallel block
 
+        flushLocalResidualProfiles_();
+        EWOMS_PROFILE_COUNT("elements", numElements);
+        EWOMS_PROFILE_COUNT("faces", numFaces);
+
         // after reduction from the parallel block, exceptionPtr will point to
         // a valid exception if one occurred in one of the threads; rethrow
         // it here to let the outer handler take care of it properly
@@ -518,11 +755,13 @@ private:
             std::rethrow_exception(exceptionPtr);
         }
 
-        applyConstraintsToLinearization_();
+        applyConstraintsToLinearization_(residualOnly);
     }
 
-    // linearize an element in the interior of the process' grid partition
-    void linearizeElement_(const Element& elem)
+    // linearize an element in the interior of the process' grid partition. if only the
+    // residual is requested, the local Jacobian matrix is not computed. returns the
+    // number of interior faces of the element.
+    unsigned linearizeElement_(const Element& elem, bool residualOnly)
     {
         unsigned threadId = ThreadManager::threadId();
 
@@ -530,29 +769,40 @@ private:
         auto& localLinearizer = model_().localLinearizer(threadId);
 
         // the actual work of linearization is done by the local linearizer class
-        localLinearizer.linearize(*elementCtx, elem);
+        if (residualOnly)
+            localLinearizer.evalResidual(*elementCtx, elem);
+        else
+            localLinearizer.linearize(*elementCtx, elem);
 
         // update the right hand side and the Jacobian matrix
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        const bool useLock = getPropValue<TypeTag, Properties::UseLinearizationLock>() && !useColoredLinearization_();
+        if (useLock)
             globalMatrixMutex_.lock();
 
+        // the blocks of the element are ordered by primary degree of freedom first, see
+        // updateBlockAddresses_()
+        MatrixBlock* const* blockAddress =
+            elementBlockAddresses_.data() + elementBlockOffsets_[elementMapper_().index(elem)];
+
         size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+        size_t numDof = elementCtx->numDof(/*timeIdx=*/0);
         for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
             unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
 
             // update the right hand side
             residual_[globI] += localLinearizer.residual(primaryDofIdx);
+            if (residualOnly)
+                continue;
 
             // update the global Jacobian matrix
-            for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx) {
-                unsigned globJ = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
-
-                jacobian_->addToBlock(globJ, globI, localLinearizer.jacobian(dofIdx, primaryDofIdx));
-            }
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++ dofIdx, ++ blockAddress)
+                **blockAddress += localLinearizer.jacobian(dofIdx, primaryDofIdx);
         }
 
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        if (useLock)
             globalMatrixMutex_.unlock();
+
+        return elementCtx->numInteriorFaces(/*timeIdx=*/0);
     }
 
     // apply the constraints to the solution. (i.e., the solution of constraint degrees
@@ -576,7 +826,7 @@ private:
 
     // apply the constraints to the linearization. (i.e., for constrain degrees of
     // freedom the Jacobian matrix maps to identity and the residual is zero)
-    void applyConstraintsToLinearization_()
+    void applyConstraintsToLinearization_(bool residualOnly)
     {
         if (!enableConstraints_())
             return;
@@ -588,7 +838,8 @@ private:
 
             // reset the column of the Jacobian matrix
             // put an identity matrix on the main diagonal of the Jacobian
-            jacobian_->clearRow(constraintDofIdx, Scalar(1.0));
+            if (!residualOnly)
+                jacobian_->clearRow(constraintDofIdx, Scalar(1.0));
 
             // make the right-hand side of constraint DOFs zero
             residual_[constraintDofIdx] = 0.0;
@@ -598,12 +849,21 @@ private:
     static bool enableConstraints_()
     { return getPropValue<TypeTag, Properties::EnableConstraints>(); }
 
+    // coloring is only required if the elements would otherwise need to be locked
+    bool useColoredLinearization_() const
+    {
+        return enableColoredLinearization_
+            && getPropValue<TypeTag, Properties::UseLinearizationLock>()
+            && ThreadManager::maxThreads() > 1;
+    }
+
     Simulator *simulatorPtr_;
     std::vector<ElementContext*> elementCtx_;
 
     // The constraint equations (only non-empty if the
     // EnableConstraints property is true)
     std::map<unsigned, Constraints> constraintsMap_;
+    unsigned constraintsMapVersion_ = 0;
 
 
     struct FlowInfo
@@ -618,12 +878,25 @@ private:
     // the jacobian matrix
     std::unique_ptr<SparseMatrixAdapter> jacobian_;
 
+    // the addresses of the matrix blocks of all elements. the ones of an element start
+    // at elementBlockOffsets_[elemIdx] and are ordered like the loops of
+    // linearizeElement_()
+    std::vector<MatrixBlock*> elementBlockAddresses_;
+    std::vector<std::size_t> elementBlockOffsets_;
+
     // the right-hand side
     GlobalEqVector residual_;
 
     LinearizationType linearizationType_;
 
     std::mutex globalMatrixMutex_;
+
+    // the elements sorted by color. color c spans the range
+    // [elementColorOffsets_[c], elementColorOffsets_[c + 1]) of elementColorSeeds_
+    std::vector<ElementSeed> elementColorSeeds_;
+    std::vector<std::size_t> elementColorOffsets_;
+    int elementColorSeqNum_ = -1;
+    bool enableColoredLinearization_;
 };
 
 } // namespace Opm
@@ -32,6 +32,7 @@
 
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/alignedallocator.hh>
+#include <opm/models/utils/profiler.hh>
 
 #include <opm/material/common/Valgrind.hpp>
 
@@ -71,6 +72,7 @@ private:
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
     using BoundaryContext = GetPropType<TypeTag, Properties::BoundaryContext>;
+    using GradientCalculator = GetPropType<TypeTag, Properties::GradientCalculator>;
 
     static constexpr bool useVolumetricResidual = getPropValue<TypeTag, Properties::UseVolumetricResidual>();
 
@@ -171,23 +173,68 @@ public:
         // evaluate the boundary conditions
         asImp_().evalBoundary_(residual, elemCtx, /*timeIdx=*/0);
 
-        if (useVolumetricResidual) {
-            // make the residual volume specific (i.e., make it incorrect mass per cubic
-            // meter instead of total mass)
-            size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
-            for (unsigned dofIdx=0; dofIdx < numDof; ++dofIdx) {
-                if (elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0) > 0.0) {
-                    // interior DOF
-                    Scalar dofVolume = elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0);
+        makeVolumetric_(residual, elemCtx);
+    }
 
-                    assert(std::isfinite(dofVolume));
-                    Valgrind::CheckDefined(dofVolume);
+    /*!
+     * \brief Compute the terms of the local residual which depend on the primary
+     *        variables of a single degree of freedom.
+     *
+     * These are the fluxes over the sub-control volume faces adjacent to the degree of
+     * freedom and its storage, source and boundary terms. All other entries of the
+     * residual are zero. This is only valid if supportsLocalizedEval() is true.
+     *
+     * \copydetails Doxygen::residualParam
+     * \copydetails Doxygen::ecfvElemCtxParam
+     * \param dofIdx The local index of the degree of freedom
+     */
+    void evalLocalized(LocalEvalBlockVector& residual,
+                       ElementContext& elemCtx,
+                       unsigned dofIdx) const
+    {
+        assert(residual.size() == elemCtx.numDof(/*timeIdx=*/0));
+        assert(dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0));
 
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                        residual[dofIdx][eqIdx] /= dofVolume;
-                }
-            }
+        residual = 0.0;
+
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        size_t numInteriorFaces = elemCtx.numInteriorFaces(/*timeIdx=*/0);
+        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
+            const auto& face = stencil.interiorFace(scvfIdx);
+            if (face.interiorIndex() == dofIdx || face.exteriorIndex() == dofIdx)
+                asImp_().evalFlux_(residual, elemCtx, scvfIdx, /*timeIdx=*/0);
         }
+
+        asImp_().evalVolumeTerm_(residual, elemCtx, dofIdx);
+        asImp_().evalBoundary_(residual, elemCtx, /*timeIdx=*/0, static_cast<int>(dofIdx));
+
+        makeVolumetric_(residual, elemCtx);
+    }
+
+    /*!
+     * \brief Returns true if the terms of the residual which depend on a degree of
+     *        freedom can be evaluated separately using evalLocalized().
+     *
+     * This requires that the fluxes over a face only depend on its two adjacent degrees
+     * of freedom and that the storage term does not depend on the extensive quantities.
+     */
+    static constexpr bool supportsLocalizedEval()
+    { return !extensiveStorageTerm && GradientCalculator::usesTwoPointApproximation(); }
+
+    /*!
+     * \brief Adds the time spent in the flux, storage, source and boundary terms since
+     *        the last call to the profile of the current scope.
+     *
+     * The terms are timed without creating a profile node for each of them because
+     * they are evaluated for every element. This method must not be called while
+     * another thread evaluates the local residual.
+     */
+    void flushProfile()
+    {
+        fluxProfile_.flush("flux");
+        storageProfile_.flush("storage");
+        sourceProfile_.flush("source");
+        boundaryProfile_.flush("boundary");
     }
 
     /*!
@@ -300,52 +347,10 @@ public:
                     const ElementContext& elemCtx,
                     unsigned timeIdx) const
     {
-        RateVector flux;
-
-        const auto& stencil = elemCtx.stencil(timeIdx);
         // calculate the mass flux over the sub-control volume faces
         size_t numInteriorFaces = elemCtx.numInteriorFaces(timeIdx);
-        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
-            const auto& face = stencil.interiorFace(scvfIdx);
-            unsigned i = face.interiorIndex();
-            unsigned j = face.exteriorIndex();
-
-            Valgrind::SetUndefined(flux);
-            asImp_().computeFlux(flux, /*context=*/elemCtx, scvfIdx, timeIdx);
-            Valgrind::CheckDefined(flux);
-#ifndef NDEBUG
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                assert(isfinite(flux[eqIdx]));
-#endif
-
-            Scalar alpha = elemCtx.extensiveQuantities(scvfIdx, timeIdx).extrusionFactor();
-            alpha *= face.area();
-            Valgrind::CheckDefined(alpha);
-            assert(alpha > 0.0);
-            assert(isfinite(alpha));
-
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                flux[eqIdx] *= alpha;
-
-            // The balance equation for a finite volume is given by
-            //
-            // dStorage/dt + Flux = Source
-            //
-            // where the 'Flux' and the 'Source' terms represent the
-            // mass per second which leaves the finite
-            // volume. Re-arranging this, we get
-            //
-            // dStorage/dt + Flux - Source = 0
-            //
-            // Since the mass flux as calculated by computeFlux() goes out of sub-control
-            // volume i and into sub-control volume j, we need to add the flux to finite
-            // volume i and subtract it from finite volume j
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
-                assert(isfinite(flux[eqIdx]));
-                residual[i][eqIdx] += flux[eqIdx];
-                residual[j][eqIdx] -= flux[eqIdx];
-            }
-        }
+        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++)
+            asImp_().evalFlux_(residual, elemCtx, scvfIdx, timeIdx);
 
 #if !defined NDEBUG
         // in debug mode, ensure that the residual is well-defined
@@ -415,14 +420,19 @@ public:
 protected:
     /*!
      * \brief Evaluate the boundary conditions of an element.
+     *
+     * If a degree of freedom is given, only the boundary segments adjacent to it are
+     * considered.
      */
     void evalBoundary_(LocalEvalBlockVector& residual,
                        const ElementContext& elemCtx,
-                       unsigned timeIdx) const
+                       unsigned timeIdx,
+                       int onlyDofIdx = -1) const
     {
         if (!elemCtx.onBoundary())
             return;
 
+        boundaryProfile_.start();
         BoundaryContext boundaryCtx(elemCtx);
         // move the iterator to the first boundary
         if(boundaryCtx.intersection(0).neighbor())
@@ -431,6 +441,10 @@ protected:
         // evaluate the boundary for all boundary faces of the current context
         size_t numBoundaryFaces = boundaryCtx.numBoundaryFaces(/*timeIdx=*/0);
         for (unsigned faceIdx = 0; faceIdx < numBoundaryFaces; ++faceIdx, boundaryCtx.increment()) {
+            if (onlyDofIdx >= 0 &&
+                static_cast<int>(boundaryCtx.interiorScvIndex(faceIdx, timeIdx)) != onlyDofIdx)
+                continue;
+
             // add the residual of all vertices of the boundary
             // segment
             evalBoundarySegment_(residual,
@@ -438,6 +452,7 @@ protected:
                                  faceIdx,
                                  timeIdx);
         }
+        boundaryProfile_.stop();
 
 #if !defined NDEBUG
         // in debug mode, ensure that the residual and the storage terms are well-defined
@@ -491,6 +506,32 @@ protected:
     void evalVolumeTerms_(LocalEvalBlockVector& residual,
                           ElementContext& elemCtx) const
     {
+        // evaluate the volumetric terms (storage + source terms)
+        size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned dofIdx=0; dofIdx < numPrimaryDof; dofIdx++)
+            asImp_().evalVolumeTerm_(residual, elemCtx, dofIdx);
+
+#if !defined NDEBUG
+        // in debug mode, ensure that the residual is well-defined
+        size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
+        for (unsigned i=0; i < numDof; i++) {
+            for (unsigned j = 0; j < numEq; ++ j) {
+                assert(isfinite(residual[i][j]));
+                Valgrind::CheckDefined(residual[i][j]);
+            }
+        }
+#endif
+    }
+
+    /*!
+     * \brief Add the change in the storage term and the source term of a single
+     *        sub-control volume to the local residual.
+     */
+    void evalVolumeTerm_(LocalEvalBlockVector& residual,
+                         ElementContext& elemCtx,
+                         unsigned dofIdx) const
+    {
+        storageProfile_.start();
         EvalVector tmp;
         EqVector tmp2;
         RateVector sourceRate;
@@ -498,134 +539,201 @@ protected:
         tmp = 0.0;
         tmp2 = 0.0;
 
-        // evaluate the volumetric terms (storage + source terms)
-        size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
-        for (unsigned dofIdx=0; dofIdx < numPrimaryDof; dofIdx++) {
-            Scalar extrusionFactor =
-                elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
-            Valgrind::CheckDefined(extrusionFactor);
-            assert(isfinite(extrusionFactor));
-            assert(extrusionFactor > 0.0);
-            Scalar scvVolume =
-               elemCtx.stencil(/*timeIdx=*/0).subControlVolume(dofIdx).volume() * extrusionFactor;
-            Valgrind::CheckDefined(scvVolume);
-            assert(isfinite(scvVolume));
-            assert(scvVolume > 0.0);
-
-            // if the model uses extensive quantities in its storage term, and we use
-            // automatic differention and current DOF is also not the one we currently
-            // focus on, the storage term does not need any derivatives!
-            if (!extensiveStorageTerm &&
-                !std::is_same<Scalar, Evaluation>::value &&
-                dofIdx != elemCtx.focusDofIndex())
-            {
-                asImp_().computeStorage(tmp2, elemCtx, dofIdx, /*timeIdx=*/0);
-                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                    tmp[eqIdx] = tmp2[eqIdx];
-            }
-            else
-                asImp_().computeStorage(tmp, elemCtx, dofIdx, /*timeIdx=*/0);
+        Scalar extrusionFactor =
+            elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
+        Valgrind::CheckDefined(extrusionFactor);
+        assert(isfinite(extrusionFactor));
+        assert(extrusionFactor > 0.0);
+        Scalar scvVolume =
+           elemCtx.stencil(/*timeIdx=*/0).subControlVolume(dofIdx).volume() * extrusionFactor;
+        Valgrind::CheckDefined(scvVolume);
+        assert(isfinite(scvVolume));
+        assert(scvVolume > 0.0);
+
+        // if the model uses extensive quantities in its storage term, and we use
+        // automatic differention and current DOF is also not the one we currently
+        // focus on, the storage term does not need any derivatives!
+        if (!extensiveStorageTerm &&
+            !std::is_same<Scalar, Evaluation>::value &&
+            dofIdx != elemCtx.focusDofIndex())
+        {
+            asImp_().computeStorage(tmp2, elemCtx, dofIdx, /*timeIdx=*/0);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                tmp[eqIdx] = tmp2[eqIdx];
+        }
+        else
+            asImp_().computeStorage(tmp, elemCtx, dofIdx, /*timeIdx=*/0);
 
 #ifndef NDEBUG
-            Valgrind::CheckDefined(tmp);
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                assert(isfinite(tmp[eqIdx]));
+        Valgrind::CheckDefined(tmp);
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            assert(isfinite(tmp[eqIdx]));
 #endif
 
-            if (elemCtx.enableStorageCache()) {
-                const auto& model = elemCtx.model();
-                unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-                if (model.newtonMethod().numIterations() == 0 &&
-                    !elemCtx.haveStashedIntensiveQuantities())
-                {
-                    if (!elemCtx.problem().recycleFirstIterationStorage()) {
-                        // we re-calculate the storage term for the solution of the
-                        // previous time step from scratch instead of using the one of
-                        // the first iteration of the current time step.
-                        tmp2 = 0.0;
-                        elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/1);
-                        asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
-                    }
-                    else {
-                        // if the storage term is cached and we're in the first iteration
-                        // of the time step, use the storage term of the first iteration
-                        // as the one as the solution of the last time step (this assumes
-                        // that the initial guess for the solution at the end of the time
-                        // step is the same as the solution at the beginning of the time
-                        // step. This is usually true, but some fancy preprocessing
-                        // scheme might invalidate that assumption.)
-                        for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
-                            tmp2[eqIdx] = Toolbox::value(tmp[eqIdx]);
-                    }
-
-                    Valgrind::CheckDefined(tmp2);
-
-                    model.updateCachedStorage(globalDofIdx, /*timeIdx=*/1, tmp2);
+        if (elemCtx.enableStorageCache()) {
+            const auto& model = elemCtx.model();
+            unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+            if (model.newtonMethod().numIterations() == 0 &&
+                !elemCtx.haveStashedIntensiveQuantities())
+            {
+                if (!elemCtx.problem().recycleFirstIterationStorage()) {
+                    // we re-calculate the storage term for the solution of the
+                    // previous time step from scratch instead of using the one of
+                    // the first iteration of the current time step.
+                    tmp2 = 0.0;
+                    elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/1);
+                    asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
                 }
                 else {
-                    // if the mass storage at the beginning of the time step is not cached,
-                    // if the storage term is cached and we're not looking at the first
-                    // iteration of the time step, we take the cached data.
-                    tmp2 = model.cachedStorage(globalDofIdx, /*timeIdx=*/1);
-                    Valgrind::CheckDefined(tmp2);
+                    // if the storage term is cached and we're in the first iteration
+                    // of the time step, use the storage term of the first iteration
+                    // as the one as the solution of the last time step (this assumes
+                    // that the initial guess for the solution at the end of the time
+                    // step is the same as the solution at the beginning of the time
+                    // step. This is usually true, but some fancy preprocessing
+                    // scheme might invalidate that assumption.)
+                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                        tmp2[eqIdx] = Toolbox::value(tmp[eqIdx]);
                 }
+
+                Valgrind::CheckDefined(tmp2);
+
+                model.updateCachedStorage(globalDofIdx, /*timeIdx=*/1, tmp2);
             }
             else {
                 // if the mass storage at the beginning of the time step is not cached,
-                // we re-calculate it from scratch.
-                tmp2 = 0.0;
-                asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
+                // if the storage term is cached and we're not looking at the first
+                // iteration of the time step, we take the cached data.
+                tmp2 = model.cachedStorage(globalDofIdx, /*timeIdx=*/1);
                 Valgrind::CheckDefined(tmp2);
             }
+        }
+        else {
+            // if the mass storage at the beginning of the time step is not cached,
+            // we re-calculate it from scratch.
+            tmp2 = 0.0;
+            asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
+            Valgrind::CheckDefined(tmp2);
+        }
 
-            // Use the implicit Euler time discretization
-            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
-                double dt = elemCtx.simulator().timeStepSize();
-                assert(dt > 0);
-                tmp[eqIdx] -= tmp2[eqIdx];
-                tmp[eqIdx] *= scvVolume / dt;
+        // Use the implicit Euler time discretization
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            double dt = elemCtx.simulator().timeStepSize();
+            assert(dt > 0);
+            tmp[eqIdx] -= tmp2[eqIdx];
+            tmp[eqIdx] *= scvVolume / dt;
 
-                residual[dofIdx][eqIdx] += tmp[eqIdx];
-            }
+            residual[dofIdx][eqIdx] += tmp[eqIdx];
+        }
 
-            Valgrind::CheckDefined(residual[dofIdx]);
+        Valgrind::CheckDefined(residual[dofIdx]);
+        storageProfile_.stop();
 
-            // deal with the source term
-            asImp_().computeSource(sourceRate, elemCtx, dofIdx, /*timeIdx=*/0);
+        // deal with the source term
+        sourceProfile_.start();
+        asImp_().computeSource(sourceRate, elemCtx, dofIdx, /*timeIdx=*/0);
 
-            // if the model uses extensive quantities in its storage term, and we use
-            // automatic differention and current DOF is also not the one we currently
-            // focus on, the storage term does not need any derivatives!
-            if (!extensiveStorageTerm &&
-                !std::is_same<Scalar, Evaluation>::value &&
-                dofIdx != elemCtx.focusDofIndex())
-            {
-                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
-                    residual[dofIdx][eqIdx] -= scalarValue(sourceRate[eqIdx])*scvVolume;
-            }
-            else {
-                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
-                    sourceRate[eqIdx] *= scvVolume;
-                    residual[dofIdx][eqIdx] -= sourceRate[eqIdx];
-                }
+        // if the model uses extensive quantities in its storage term, and we use
+        // automatic differention and current DOF is also not the one we currently
+        // focus on, the storage term does not need any derivatives!
+        if (!extensiveStorageTerm &&
+            !std::is_same<Scalar, Evaluation>::value &&
+            dofIdx != elemCtx.focusDofIndex())
+        {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                residual[dofIdx][eqIdx] -= scalarValue(sourceRate[eqIdx])*scvVolume;
+        }
+        else {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                sourceRate[eqIdx] *= scvVolume;
+                residual[dofIdx][eqIdx] -= sourceRate[eqIdx];
             }
+        }
 
-            Valgrind::CheckDefined(residual[dofIdx]);
+        Valgrind::CheckDefined(residual[dofIdx]);
+        sourceProfile_.stop();
+    }
+
+    /*!
+     * \brief Add the flux over a single sub-control volume face to a local residual.
+     */
+    void evalFlux_(LocalEvalBlockVector& residual,
+                   const ElementContext& elemCtx,
+                   unsigned scvfIdx,
+                   unsigned timeIdx) const
+    {
+        fluxProfile_.start();
+        RateVector flux;
+
+        const auto& face = elemCtx.stencil(timeIdx).interiorFace(scvfIdx);
+        unsigned i = face.interiorIndex();
+        unsigned j = face.exteriorIndex();
+
+        Valgrind::SetUndefined(flux);
+        asImp_().computeFlux(flux, /*context=*/elemCtx, scvfIdx, timeIdx);
+        Valgrind::CheckDefined(flux);
+#ifndef NDEBUG
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            assert(isfinite(flux[eqIdx]));
+#endif
+
+        Scalar alpha = elemCtx.extensiveQuantities(scvfIdx, timeIdx).extrusionFactor();
+        alpha *= face.area();
+        Valgrind::CheckDefined(alpha);
+        assert(alpha > 0.0);
+        assert(isfinite(alpha));
+
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+            flux[eqIdx] *= alpha;
+
+        // The balance equation for a finite volume is given by
+        //
+        // dStorage/dt + Flux = Source
+        //
+        // where the 'Flux' and the 'Source' terms represent the
+        // mass per second which leaves the finite
+        // volume. Re-arranging this, we get
+        //
+        // dStorage/dt + Flux - Source = 0
+        //
+        // Since the mass flux as calculated by computeFlux() goes out of sub-control
+        // volume i and into sub-control volume j, we need to add the flux to finite
+        // volume i and subtract it from finite volume j
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            assert(isfinite(flux[eqIdx]));
+            residual[i][eqIdx] += flux[eqIdx];
+            residual[j][eqIdx] -= flux[eqIdx];
         }
+        fluxProfile_.stop();
+    }
 
-#if !defined NDEBUG
-        // in debug mode, ensure that the residual is well-defined
+    /*!
+     * \brief Divide the residual of each degree of freedom by its volume if the
+     *        residual is volume specific.
+     */
+    void makeVolumetric_(LocalEvalBlockVector& residual,
+                         const ElementContext& elemCtx) const
+    {
+        if (!useVolumetricResidual)
+            return;
+
+        // make the residual volume specific (i.e., make it incorrect mass per cubic
+        // meter instead of total mass)
         size_t numDof = elemCtx.numDof(/*timeIdx=*/0);
-        for (unsigned i=0; i < numDof; i++) {
-            for (unsigned j = 0; j < numEq; ++ j) {
-                assert(isfinite(residual[i][j]));
-                Valgrind::CheckDefined(residual[i][j]);
+        for (unsigned dofIdx=0; dofIdx < numDof; ++dofIdx) {
+            if (elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0) > 0.0) {
+                // interior DOF
+                Scalar dofVolume = elemCtx.dofTotalVolume(dofIdx, /*timeIdx=*/0);
+
+                assert(std::isfinite(dofVolume));
+                Valgrind::CheckDefined(dofVolume);
+
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx)
+                    residual[dofIdx][eqIdx] /= dofVolume;
             }
         }
-#endif
     }
 
-
 private:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
@@ -634,6 +742,12 @@ private:
     { return *static_cast<const Implementation*>(this); }
 
     LocalEvalBlockVector internalResidual_;
+
+    // time spent in the individual terms of the residual, see flushProfile()
+    mutable ProfileAccumulator fluxProfile_;
+    mutable ProfileAccumulator storageProfile_;
+    mutable ProfileAccumulator sourceProfile_;
+    mutable ProfileAccumulator boundaryProfile_;
 };
 
 } // namespace Opm
@@ -31,8 +31,11 @@
 #include "fvbasenewtonconvergencewriter.hh"
 
 #include <opm/models/nonlinear/newtonmethod.hh>
+#include <opm/models/utils/profiler.hh>
 #include <opm/models/utils/propertysystem.hh>
 
+#include <cmath>
+
 namespace Opm {
 
 template <class TypeTag>
@@ -128,8 +131,12 @@ protected:
         ParentType::update_(nextSolution, currentSolution, solutionUpdate, currentResidual);
 
         // make sure that the intensive quantities get recalculated at the next
-        // linearization
-        if (model_().storeIntensiveQuantities()) {
+        // linearization. if they are updated incrementally, this only considers the
+        // local update: the primary variables of the overlap are changed again by
+        // syncOverlap() in beginIteration_(), which thus checks them once more.
+        if (model_().enableIncrementalIntensiveQuantities())
+            invalidateChangedIntensiveQuantities_(nextSolution);
+        else if (model_().storeIntensiveQuantities()) {
             for (unsigned dofIdx = 0; dofIdx < model_().numGridDof(); ++dofIdx)
                 model_().setIntensiveQuantitiesCacheEntryValidity(dofIdx,
                                                                   /*timeIdx=*/0,
@@ -137,16 +144,80 @@ protected:
         }
     }
 
+    /*!
+     * \brief Returns true if the intensive quantities of a degree of freedom need to be
+     *        recomputed after its primary variables have been updated.
+     *
+     * This is the case if any primary variable differs by more than the relative
+     * tolerance of the incremental intensive quantity update from the one used to
+     * compute the cached intensive quantities. Models which can change the meaning of
+     * their primary variables need to overload this method.
+     *
+     * \param nextValue The primary variables after the update
+     * \param currentValue The primary variables from which the cached intensive
+     *                     quantities were computed
+     * \param tolerance The relative change above which a primary variable is
+     *                  considered to have changed
+     */
+    bool primaryVariablesChanged_(const PrimaryVariables& nextValue,
+                                  const PrimaryVariables& currentValue,
+                                  Scalar tolerance) const
+    {
+        for (unsigned pvIdx = 0; pvIdx < nextValue.size(); ++pvIdx) {
+            using std::abs;
+            if (abs(nextValue[pvIdx] - currentValue[pvIdx]) > tolerance*abs(currentValue[pvIdx]))
+                return true;
+        }
+
+        return false;
+    }
+
     /*!
      * \brief Indicates the beginning of a Newton iteration.
      */
     void beginIteration_()
     {
-        model_().syncOverlap();
+        {
+            EWOMS_PROFILE_SCOPE("mpi_sync");
+            model_().syncOverlap();
+        }
+
+        // the solution of the degrees of freedom which are mastered by a peer process
+        // has just been overwritten, so the cache entries computed from their previous
+        // primary variables may be outdated
+        if (model_().enableIncrementalIntensiveQuantities()
+            && this->simulator_.gridView().comm().size() > 1)
+            invalidateChangedIntensiveQuantities_(model_().solution(/*timeIdx=*/0));
 
         ParentType::beginIteration_();
     }
 
+    /*!
+     * \brief Indicates that one Newton iteration was finished.
+     *
+     * If the intensive quantities are updated incrementally, this reports the
+     * fraction of the intensive quantity updates which were skipped when the system
+     * was linearized in this iteration.
+     */
+    void endIteration_(const SolutionVector& uCurrentIter,
+                       const SolutionVector& uLastIter)
+    {
+        if (model_().enableIncrementalIntensiveQuantities()) {
+            long numSkipped;
+            long numVisited;
+            model_().intensiveQuantitiesSkipStatistics(numSkipped, numVisited);
+
+            const auto& comm = this->simulator_.gridView().comm();
+            const double numTotal = comm.sum(static_cast<double>(numVisited));
+            const double numSkippedTotal = comm.sum(static_cast<double>(numSkipped));
+            const double skippedFraction = numTotal > 0 ? numSkippedTotal/numTotal : 0.0;
+            this->endIterMsg() << ", intensive quantities skipped="
+                               << std::round(1000*skippedFraction)/10 << "%";
+        }
+
+        ParentType::endIteration_(uCurrentIter, uLastIter);
+    }
+
     /*!
      * \brief Returns a reference to the model.
      */
@@ -160,11 +231,45 @@ protected:
     { return ParentType::model(); }
 
 private:
+    // only invalidate the cached intensive quantities of the degrees of freedom whose
+    // primary variables differ from the ones from which they were computed. comparing
+    // with the last iterate instead would allow changes below the tolerance to
+    // accumulate without bounds.
+    void invalidateChangedIntensiveQuantities_(const SolutionVector& nextSolution)
+    {
+        EWOMS_PROFILE_SCOPE("invalidate_intensive_quantities");
+        const Scalar tolerance = model_().intensiveQuantitiesUpdateTolerance();
+        const long numGridDof = static_cast<long>(model_().numGridDof());
+
+        long numChanged = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:numChanged)
+#endif
+        for (long i = 0; i < numGridDof; ++i) {
+            const unsigned dofIdx = static_cast<unsigned>(i);
+            // entries which are already invalid are recomputed anyway
+            if (!model_().cachedIntensiveQuantities(dofIdx, /*timeIdx=*/0))
+                continue;
+
+            if (asImp_().primaryVariablesChanged_(nextSolution[dofIdx],
+                                                  model_().cachedIntensiveQuantitiesPrimaryVars(dofIdx),
+                                                  tolerance))
+            {
+                model_().setIntensiveQuantitiesCacheEntryValidity(dofIdx,
+                                                                  /*timeIdx=*/0,
+                                                                  /*valid=*/false);
+                ++numChanged;
+            }
+        }
+        EWOMS_PROFILE_COUNT("intensive_quantities_changed", numChanged);
+    }
+
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
 };
 } // namespace Opm
 
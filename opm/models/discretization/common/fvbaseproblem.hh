@@ -39,6 +39,8 @@
 #include <iostream>
 #include <limits>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include <sys/stat.h>
 
@@ -104,6 +106,17 @@ private:
     // copying a problem is not a good idea
     FvBaseProblem(const FvBaseProblem& ) = delete;
 
+    // the linear solver backends which are derived from ParallelBaseBackend keep
+    // statistics about their preconditioner
+    template <class LinearSolver, class = void>
+    struct HasPreconditionerStatistics_ : public std::false_type {};
+    template <class LinearSolver>
+    struct HasPreconditionerStatistics_<LinearSolver,
+                                        std::void_t<decltype(std::declval<const LinearSolver&>().numPreconditionerSetups()),
+                                                    decltype(std::declval<const LinearSolver&>().preconditionerSetupTimer()),
+                                                    decltype(std::declval<const LinearSolver&>().solverApplyTimer())>>
+        : public std::true_type {};
+
 public:
     /*!
      * \copydoc Doxygen::defaultProblemConstructor
@@ -487,8 +500,21 @@ public:
                       << "    Linearization time: " << linearizeTime << " seconds" << Simulator::humanReadableTime(linearizeTime)
                       << ", " << linearizeTime/executionTime*100 << "%\n"
                       << "    Linear solve time: "  << solveTime << " seconds" << Simulator::humanReadableTime(solveTime)
-                      << ", " << solveTime/executionTime*100 << "%\n"
-                      << "    Newton update time: "  << updateTime << " seconds" << Simulator::humanReadableTime(updateTime)
+                      << ", " << solveTime/executionTime*100 << "%\n";
+
+            const auto& linearSolver = asImp_().newtonMethod().linearSolver();
+            using LinearSolver = std::decay_t<decltype(linearSolver)>;
+            if constexpr (HasPreconditionerStatistics_<LinearSolver>::value) {
+                Scalar precondSetupTime = linearSolver.preconditionerSetupTimer().realTimeElapsed();
+                Scalar solverApplyTime = linearSolver.solverApplyTimer().realTimeElapsed();
+                std::cout << "        Preconditioner setup time: " << precondSetupTime << " seconds" << Simulator::humanReadableTime(precondSetupTime)
+                          << ", " << precondSetupTime/executionTime*100 << "%"
+                          << ", " << linearSolver.numPreconditionerSetups() << " setups\n"
+                          << "        Krylov solver time: " << solverApplyTime << " seconds" << Simulator::humanReadableTime(solverApplyTime)
+                          << ", " << solverApplyTime/executionTime*100 << "%\n";
+            }
+
+            std::cout << "    Newton update time: "  << updateTime << " seconds" << Simulator::humanReadableTime(updateTime)
                       << ", " << updateTime/executionTime*100 << "%\n"
                       << "    Pre/postprocess time: "  << prePostProcessTime << " seconds" << Simulator::humanReadableTime(prePostProcessTime)
                       << ", " << prePostProcessTime/executionTime*100 << "%\n"
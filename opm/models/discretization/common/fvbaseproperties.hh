@@ -196,6 +196,12 @@ struct ThreadsPerProcess { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct UseLinearizationLock { using type = UndefinedProperty; };
 
+//! Linearize the elements in groups of elements which do not share any primary degree
+//! of freedom instead of protecting the global system of equations by a lock. (this is
+//! only relevant in multi-threaded mode and if UseLinearizationLock is true.)
+template<class TypeTag, class MyTypeTag>
+struct EnableColoredLinearization { using type = UndefinedProperty; };
+
 // high-level simulation control
 
 /*!
@@ -293,6 +299,39 @@ struct ContinueOnConvergenceError { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct EnableIntensiveQuantityCache { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specify whether the Newton method should only invalidate the cached intensive
+ *        quantities of the degrees of freedom whose primary variables were changed by
+ *        the update.
+ *
+ * This only has an effect if the intensive quantity cache is enabled. Code which
+ * modifies the solution outside of the Newton update must then take care of
+ * invalidating the affected cache entries itself.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableIncrementalIntensiveQuantities { using type = UndefinedProperty; };
+
+/*!
+ * \brief The relative change of a primary variable above which the cached intensive
+ *        quantities of a degree of freedom are considered to be outdated.
+ *
+ * This is only used if the intensive quantities are updated incrementally. The default
+ * of zero only reuses the cached quantities if the primary variables did not change at
+ * all.
+ */
+template<class TypeTag, class MyTypeTag>
+struct IntensiveQuantitiesUpdateTolerance { using type = UndefinedProperty; };
+
+/*!
+ * \brief Specify whether the finite volume stencils of all elements should be stored
+ *        instead of being recomputed for each linearization.
+ *
+ * The stencils only need to be recomputed if the grid changes, but storing them
+ * requires a considerable amount of memory.
+ */
+template<class TypeTag, class MyTypeTag>
+struct EnableStencilCache { using type = UndefinedProperty; };
+
 /*!
  * \brief Specify whether the storage terms for previous solutions should be cached.
  *
@@ -0,0 +1,110 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::StencilCache
+ */
+#ifndef EWOMS_STENCIL_CACHE_HH
+#define EWOMS_STENCIL_CACHE_HH
+
+#include <opm/models/parallel/threadedentityiterator.hh>
+
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Stores the finite volume stencils of all elements of a grid.
+ *
+ * The geometry of a stencil only changes if the grid is modified, so the stencils are
+ * computed once and reused by all later linearizations. update() recomputes them in
+ * parallel if the sequence number of the grid has changed.
+ *
+ * Since stencils can be quite large, this trades memory for computation time.
+ */
+template <class GridView, class Stencil, class DofMapper, class ElementMapper>
+class StencilCache
+{
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementIterator = typename GridView::template Codim<0>::Iterator;
+
+public:
+    StencilCache(const GridView& gridView,
+                 const DofMapper& dofMapper,
+                 const ElementMapper& elementMapper)
+        : gridView_(gridView)
+        , dofMapper_(dofMapper)
+        , elementMapper_(elementMapper)
+    { }
+
+    /*!
+     * \brief Recompute the stencils of all elements if the grid has changed.
+     *
+     * \param gridSequenceNumber The sequence number of the current grid
+     * \param chunks The chunks of elements used by the threaded loops of the model,
+     *               see FvBaseDiscretization::elementChunks()
+     */
+    template <class ElementChunks>
+    void update(int gridSequenceNumber, const ElementChunks& chunks)
+    {
+        if (gridSequenceNumber_ == gridSequenceNumber)
+            return;
+
+        gridSequenceNumber_ = gridSequenceNumber;
+
+        stencils_.clear();
+        stencils_.resize(elementMapper_.size(), Stencil(gridView_, dofMapper_));
+
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_, chunks);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                const Element& elem = *elemIt;
+                stencils_[elementMapper_.index(elem)].update(elem);
+            }
+        }
+    }
+
+    /*!
+     * \brief Returns the stencil of an element.
+     */
+    const Stencil& get(const Element& elem) const
+    { return stencils_[elementMapper_.index(elem)]; }
+
+private:
+    const GridView& gridView_;
+    const DofMapper& dofMapper_;
+    const ElementMapper& elementMapper_;
+    std::vector<Stencil> stencils_;
+    int gridSequenceNumber_ = -1;
+};
+
+} // namespace Opm
+
+#endif
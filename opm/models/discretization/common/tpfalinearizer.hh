@@ -35,6 +35,9 @@
 #include <opm/common/TimingMacros.hpp>
 
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/utils/profiler.hh>
+#include <opm/simulators/linalg/csrsparsitypattern.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
 
 #include <opm/grid/utility/SparseTable.hpp>
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
@@ -50,6 +53,7 @@
 #include <set>
 #include <exception>   // current_exception, rethrow_exception
 #include <mutex>
+#include <utility>
 
 namespace Opm::Properties {
     template<class TypeTag, class MyTypeTag>
@@ -57,6 +61,12 @@ namespace Opm::Properties {
         using type = bool;
         static constexpr type value = false;
     };
+
+    template<class TypeTag, class MyTypeTag>
+    struct EnableIntensiveQuantitiesSoA {
+        using type = bool;
+        static constexpr type value = false;
+    };
 }
 
 namespace Opm {
@@ -73,6 +83,11 @@ class EcfvDiscretization;
  * This class assumes that these system of equations to be linearized are stemming from
  * models that use an finite volume scheme for spatial discretization and an Euler
  * scheme for time discretization.
+ *
+ * The flux terms are assembled cell by cell, so each interior face is evaluated once
+ * from each of its two cells. The cached intensive quantities only carry derivatives
+ * with regard to the primary variables of their own cell, which means that a single
+ * evaluation of a face cannot provide the Jacobian entries of both cells.
  */
 template<class TypeTag>
 class TpfaLinearizer
@@ -109,6 +124,40 @@ class TpfaLinearizer
 
     static const bool linearizeNonLocalElements = getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
 
+    // the structure-of-arrays copy of the intensive quantities is only available if
+    // the local residual provides one and supports computing the fluxes from it
+    struct NoIntensiveQuantitiesSoA_ {};
+    template <class LocalRes, class = void>
+    struct IntensiveQuantitiesSoAOf_
+    {
+        using type = NoIntensiveQuantitiesSoA_;
+        static constexpr bool value = false;
+    };
+    template <class LocalRes>
+    struct IntensiveQuantitiesSoAOf_<LocalRes, std::void_t<typename LocalRes::IntensiveQuantitiesSoA> >
+    {
+        using type = typename LocalRes::IntensiveQuantitiesSoA;
+        static constexpr bool value = LocalRes::intensiveQuantitiesSoASupported;
+    };
+    using IntensiveQuantitiesSoA = typename IntensiveQuantitiesSoAOf_<LocalResidual>::type;
+    static constexpr bool hasIntensiveQuantitiesSoA = IntensiveQuantitiesSoAOf_<LocalResidual>::value;
+
+    // if only the residual is requested, the fluxes are evaluated without derivatives
+    // if the local residual is able to do so
+    template <class LocalRes, class = void>
+    struct HasFluxValues_ : public std::false_type {};
+    template <class LocalRes>
+    struct HasFluxValues_<LocalRes,
+                          std::void_t<decltype(LocalRes::computeFluxValues(std::declval<VectorBlock&>(),
+                                                                           std::declval<VectorBlock&>(),
+                                                                           0u,
+                                                                           0u,
+                                                                           std::declval<const IntensiveQuantities&>(),
+                                                                           std::declval<const IntensiveQuantities&>(),
+                                                                           std::declval<const typename LocalRes::ResidualNBInfo&>()))> >
+        : public std::true_type {};
+    static constexpr bool hasFluxValues = HasFluxValues_<LocalResidual>::value;
+
     // copying the linearizer is not a good idea
     TpfaLinearizer(const TpfaLinearizer&);
 //! \endcond
@@ -119,6 +168,8 @@ public:
     {
         simulatorPtr_ = 0;
         separateSparseSourceTerms_ = EWOMS_GET_PARAM(TypeTag, bool, SeparateSparseSourceTerms);
+        enableIntensiveQuantitiesSoA_ =
+            hasIntensiveQuantitiesSoA && EWOMS_GET_PARAM(TypeTag, bool, EnableIntensiveQuantitiesSoA);
     }
 
     ~TpfaLinearizer()
@@ -132,6 +183,8 @@ public:
     {
         EWOMS_REGISTER_PARAM(TypeTag, bool, SeparateSparseSourceTerms,
                              "Treat well source terms all in one go, instead of on a cell by cell basis.");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableIntensiveQuantitiesSoA,
+                             "Gather the intensive quantities required by the flux terms into contiguous arrays before assembling the fluxes. This is ignored if directional relative permeabilities or extensions of the black-oil model are used.");
     }
 
     /*!
@@ -189,37 +242,32 @@ public:
     void linearizeDomain()
     {
         OPM_TIMEBLOCK(linearizeDomain);
-        // we defer the initialization of the Jacobian matrix until here because the
-        // auxiliary modules usually assume the problem, model and grid to be fully
-        // initialized...
-        if (!jacobian_)
-            initFirstIteration_();
-
-        int succeeded;
-        try {
-            linearize_();
-            succeeded = 1;
-        }
-        catch (const std::exception& e)
-        {
-            std::cout << "rank " << simulator_().gridView().comm().rank()
-                      << " caught an exception while linearizing:" << e.what()
-                      << "\n"  << std::flush;
-            succeeded = 0;
-        }
-        catch (...)
-        {
-            std::cout << "rank " << simulator_().gridView().comm().rank()
-                      << " caught an exception while linearizing"
-                      << "\n"  << std::flush;
-            succeeded = 0;
-        }
-        succeeded = gridView_().comm().min(succeeded);
+        linearizeDomain_(/*residualOnly=*/false);
+    }
 
-        if (!succeeded)
-            throw NumericalProblem("A process did not succeed in linearizing the system");
+    /*!
+     * \brief Evaluate the residual of the spatial domain but keep the Jacobian matrix
+     *        of the most recent linearization.
+     *
+     * This is used by Newton iterations which reuse the Jacobian matrix of a previous
+     * iteration. The derivatives are neither extracted nor written to the matrix.
+     */
+    void linearizeDomainResidual()
+    {
+        OPM_TIMEBLOCK(linearizeDomainResidual);
+        linearizeDomain_(/*residualOnly=*/true);
     }
 
+    /*!
+     * \brief Returns true if linearizeDomainResidual() can be used.
+     *
+     * This is not the case if auxiliary modules or the sparse source terms of the well
+     * model contribute to the Jacobian matrix because these are always assembled
+     * together with their residual.
+     */
+    bool supportsResidualOnlyLinearization() const
+    { return jacobian_ && model_().numAuxiliaryModules() == 0 && !separateSparseSourceTerms_; }
+
     void finalize()
     { jacobian_->finalize(); }
 
@@ -314,6 +362,15 @@ public:
     const std::map<unsigned, Constraints> constraintsMap() const
     { return {}; }
 
+    /*!
+     * \brief Returns a number which changes whenever the map of the constraint degrees
+     *        of freedom is rebuilt.
+     *
+     * Since the map is always empty, this never changes.
+     */
+    unsigned constraintsMapVersion() const
+    { return 0; }
+
 private:
     Simulator& simulator_()
     { return *simulatorPtr_; }
@@ -358,11 +415,6 @@ private:
         const auto& model = model_();
         Stencil stencil(gridView_(), model_().dofMapper());
 
-        // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        using NeighborSet = std::set< unsigned >;
-        std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
-
         unsigned numCells = model.numTotalDof();
         neighborInfo_.reserve(numCells, 6 * numCells);
         std::vector<NeighborInfo> loc_nbinfo;
@@ -377,7 +429,6 @@ private:
 
                 for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
                     unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
                     if (dofIdx > 0) {
                         const double trans = problem_().transmissibility(myIdx, neighborIdx);
                         const auto scvfIdx = dofIdx - 1;
@@ -387,7 +438,12 @@ private:
                         if (materialLawManager->hasDirectionalRelperms()) {
                             dirId = scvf.faceDirFromDirId();
                         }
-                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx, trans, area, dirId, nullptr};
+                        auto distVec = stencil.subControlVolume(primaryDofIdx).globalPos();
+                        distVec -= stencil.subControlVolume(dofIdx).globalPos();
+                        const auto resNBInfo =
+                            LocalResidual::residualNBInfo(problem_(), myIdx, neighborIdx, trans, area,
+                                                          distVec.two_norm(), dirId);
+                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx, resNBInfo, nullptr};
                     }
                 }
                 neighborInfo_.appendRow(loc_nbinfo.begin(), loc_nbinfo.end());
@@ -416,11 +472,42 @@ private:
             }
         }
 
-        // add the additional neighbors and degrees of freedom caused by the auxiliary
-        // equations
-        size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
+        // the auxiliary equations specify their additional neighbors and degrees of
+        // freedom as a set per row. since they only affect a few rows, this is cheap
+        // compared to doing the same for the cells.
+        std::vector<std::set<unsigned>> auxSparsityPattern;
+        const size_t numAuxMod = model.numAuxiliaryModules();
+        if (numAuxMod > 0) {
+            auxSparsityPattern.resize(numCells);
+            for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+                model.auxiliaryModule(auxModIdx)->addNeighbors(auxSparsityPattern);
+        }
+
+        // the row of each cell couples it to itself and to its neighbors
+        Linear::CsrSparsityPattern sparsityPattern;
+        sparsityPattern.beginCount(numCells);
+        const unsigned numRows = neighborInfo_.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numRows; ++globI)
+            sparsityPattern.count(globI, 1 + neighborInfo_[globI].size());
+        if (numAuxMod > 0)
+            sparsityPattern.count(auxSparsityPattern);
+
+        sparsityPattern.beginFill();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numRows; ++globI) {
+            sparsityPattern.add(globI, globI);
+            for (const auto& nbInfo : neighborInfo_[globI])
+                sparsityPattern.add(globI, nbInfo.neighbor);
+        }
+        if (numAuxMod > 0)
+            sparsityPattern.add(auxSparsityPattern);
+
+        sparsityPattern.finalize();
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
@@ -434,14 +521,52 @@ private:
                 nbInfo.matBlockAddress = jacobian_->blockAddress(nbInfo.neighbor, globI);
             }
         }
+
+        // the gathered intensive quantities only contain the non-directional mobilities
+        if (materialLawManager->hasDirectionalRelperms())
+            enableIntensiveQuantitiesSoA_ = false;
+    }
+
+    void linearizeDomain_(bool residualOnly)
+    {
+        // we defer the initialization of the Jacobian matrix until here because the
+        // auxiliary modules usually assume the problem, model and grid to be fully
+        // initialized...
+        if (!jacobian_)
+            initFirstIteration_();
+
+        int succeeded;
+        try {
+            linearize_(residualOnly);
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while linearizing:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while linearizing"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = gridView_().comm().min(succeeded);
+
+        if (!succeeded)
+            throw NumericalProblem("A process did not succeed in linearizing the system");
     }
 
     // reset the global linear system of equations.
-    void resetSystem_()
+    void resetSystem_(bool residualOnly = false)
     {
         residual_ = 0.0;
         // zero all matrix entries
-        jacobian_->clear();
+        if (!residualOnly)
+            jacobian_->clear();
     }
 
     // Initialize the flows and flores sparse tables
@@ -518,25 +643,38 @@ public:
         for (unsigned eqIdx = 0; eqIdx < numEq; eqIdx++)
             res[eqIdx] = resid[eqIdx].value();
 
-        for (unsigned eqIdx = 0; eqIdx < numEq; eqIdx++) {
-            for (unsigned pvIdx = 0; pvIdx < numEq; pvIdx++) {
-                // A[dofIdx][focusDofIdx][eqIdx][pvIdx] is the partial derivative of
-                // the residual function 'eqIdx' for the degree of freedom 'dofIdx'
-                // with regard to the focus variable 'pvIdx' of the degree of freedom
-                // 'focusDofIdx'
-                bMat[eqIdx][pvIdx] = resid[eqIdx].derivative(pvIdx);
-            }
-        }
+        // A[dofIdx][focusDofIdx][eqIdx][pvIdx] is the partial derivative of the
+        // residual function 'eqIdx' for the degree of freedom 'dofIdx' with regard to the
+        // focus variable 'pvIdx' of the degree of freedom 'focusDofIdx'
+        assignDerivatives<numEq, numEq>(bMat, resid);
+    }
+
+    void setRes(VectorBlock& res, const ADVectorBlock& resid) const
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; eqIdx++)
+            res[eqIdx] = resid[eqIdx].value();
     }
 
 private:
-    void linearize_()
+    // linearize the domain. if only the residual is requested, the Jacobian matrix is
+    // left untouched.
+    void linearize_(bool residualOnly)
     {
         OPM_TIMEBLOCK(linearize);
-        resetSystem_();
+        resetSystem_(residualOnly);
         unsigned numCells = model_().numTotalDof();
         const bool& enableFlows = simulator_().problem().eclWriter()->eclOutputModule().hasFlows();
         const bool& enableFlores = simulator_().problem().eclWriter()->eclOutputModule().hasFlores();
+        // the gathered intensive quantities are not used by the value-only fluxes
+        if (enableIntensiveQuantitiesSoA_ && !(hasFluxValues && residualOnly))
+            updateIntensiveQuantitiesSoA_();
+
+        // the profile is recorded for the whole loop because timing the individual
+        // cells would cost about as much as linearizing them
+        {
+        EWOMS_PROFILE_SCOPE("linearize_cells");
+        EWOMS_PROFILE_COUNT("elements", numCells);
+        EWOMS_PROFILE_COUNT("faces", neighborInfo_.dataSize());
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
@@ -555,7 +693,7 @@ private:
 
             // Flux term.
             {
-            OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);    
+            OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
             short loc = 0;
             for (const auto& nbInfo : nbInfos) {
                 OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
@@ -570,10 +708,25 @@ private:
                     throw std::logic_error("Missing updated intensive quantities for cell " + std::to_string(globJ) + " when assembling fluxes for cell " + std::to_string(globI));
                 }
                 const IntensiveQuantities& intQuantsEx = *intQuantsExP;
-                LocalResidual::computeFlux(
-                       adres, darcyFlux, problem_(), globI, globJ, intQuantsIn, intQuantsEx,
-                           nbInfo.trans, nbInfo.faceArea, nbInfo.faceDirection);
-                adres *= nbInfo.faceArea;
+                if constexpr (hasFluxValues) {
+                    if (residualOnly) {
+                        // no derivatives are required, so only the values of the flux
+                        // are computed
+                        VectorBlock darcy;
+                        LocalResidual::computeFluxValues(
+                               res, darcy, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.resNBInfo);
+                        res *= nbInfo.resNBInfo.faceArea;
+                        if (enableFlows)
+                            flowsInfo_[globI][loc].flow = res;
+                        if (enableFlores)
+                            floresInfo_[globI][loc].flow = darcy;
+                        residual_[globI] += res;
+                        ++loc;
+                        continue;
+                    }
+                }
+                computeFlux_(adres, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo);
+                adres *= nbInfo.resNBInfo.faceArea;
                 if (enableFlows) {
                     for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
                         flowsInfo_[globI][loc].flow[phaseIdx] = adres[phaseIdx].value();
@@ -584,6 +737,12 @@ private:
                         floresInfo_[globI][loc].flow[phaseIdx] = darcyFlux[phaseIdx].value();
                     }
                 }
+                if (residualOnly) {
+                    setRes(res, adres);
+                    residual_[globI] += res;
+                    ++loc;
+                    continue;
+                }
                 setResAndJacobi(res, bMat, adres);
                 residual_[globI] += res;
                 //SparseAdapter syntax:  jacobian_->addToBlock(globI, globI, bMat);
@@ -602,9 +761,14 @@ private:
             adres = 0.0;
             {
                 OPM_TIMEBLOCK_LOCAL(computeStorage);
-                LocalResidual::computeStorage(adres, intQuantsIn);
+                if (residualOnly)
+                    // the storage term can be evaluated for scalars directly
+                    LocalResidual::computeStorage(res, intQuantsIn);
+                else
+                    LocalResidual::computeStorage(adres, intQuantsIn);
             }
-            setResAndJacobi(res, bMat, adres);
+            if (!residualOnly)
+                setResAndJacobi(res, bMat, adres);
             // TODO: check recycleFirst etc.
             // first we use it as storage cache
             if (model_().newtonMethod().numIterations() == 0) {
@@ -616,7 +780,8 @@ private:
             // residual_[globI] -= model_().cachedStorage(globI, 1); //*storefac;
             residual_[globI] += res;
             //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+            if (!residualOnly)
+                *diagMatAddress_[globI] += bMat;
 
             // Cell-wise source terms.
             // This will include well sources if SeparateSparseSourceTerms is false.
@@ -624,23 +789,31 @@ private:
             bMat = 0.0;
             adres = 0.0;
             if (separateSparseSourceTerms_) {
-                LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
+                LocalResidual::computeSourceDense(adres, problem_(), intQuantsIn, nbInfos, globI, 0);
             } else {
-                LocalResidual::computeSource(adres, problem_(), globI, 0);
+                LocalResidual::computeSource(adres, problem_(), intQuantsIn, nbInfos, globI, 0);
             }
             adres *= -volume;
+            if (residualOnly) {
+                setRes(res, adres);
+                residual_[globI] += res;
+                continue;
+            }
             setResAndJacobi(res, bMat, adres);
             residual_[globI] += res;
             //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
             *diagMatAddress_[globI] += bMat;
         } // end of loop for cell globI.
+        }
 
         // Add sparse source terms. For now only wells.
         if (separateSparseSourceTerms_) {
+            EWOMS_PROFILE_SCOPE("sparse_source");
             problem_().wellModel().addReservoirSourceTerms(residual_, diagMatAddress_);
         }
 
         // Boundary terms. Only looping over cells with nontrivial bcs.
+        EWOMS_PROFILE_SCOPE("boundary");
         for (const auto& bdyInfo : boundaryInfo_) {
             VectorBlock res(0.0);
             MatrixBlock bMat(0.0);
@@ -652,6 +825,11 @@ private:
             }
             LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, *insideIntQuants, globI);
             adres *= bdyInfo.bcdata.faceArea;
+            if (residualOnly) {
+                setRes(res, adres);
+                residual_[globI] += res;
+                continue;
+            }
             setResAndJacobi(res, bMat, adres);
             residual_[globI] += res;
             ////SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
@@ -659,6 +837,58 @@ private:
         }
     }
 
+    // Gather the quantities needed by the flux terms from the cached intensive quantities
+    // of all cells.
+    void updateIntensiveQuantitiesSoA_()
+    {
+        if constexpr (hasIntensiveQuantitiesSoA) {
+            EWOMS_PROFILE_SCOPE("gather_intensive_quantities");
+            const unsigned numCells = model_().numTotalDof();
+            if (intensiveQuantitiesSoA_.size() != numCells)
+                intensiveQuantitiesSoA_.resize(numCells);
+
+            bool allAvailable = true;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(&&:allAvailable)
+#endif
+            for (unsigned globI = 0; globI < numCells; ++globI) {
+                const IntensiveQuantities* intQuants = model_().cachedIntensiveQuantities(globI, /*timeIdx*/ 0);
+                if (intQuants == nullptr)
+                    allAvailable = false;
+                else
+                    intensiveQuantitiesSoA_.update(globI, *intQuants);
+            }
+
+            if (!allAvailable)
+                throw std::logic_error("Missing updated intensive quantities for gathering the flux quantities");
+        }
+    }
+
+    // Compute the flux over a face as seen from cell I, either using the objects for the
+    // intensive quantities or their gathered copy.
+    template <class NbInfo>
+    void computeFlux_(ADVectorBlock& adres,
+                      ADVectorBlock& darcyFlux,
+                      unsigned globI,
+                      unsigned globJ,
+                      const IntensiveQuantities& intQuantsI,
+                      const IntensiveQuantities& intQuantsJ,
+                      const NbInfo& nbInfo) const
+    {
+        if constexpr (hasIntensiveQuantitiesSoA) {
+            if (enableIntensiveQuantitiesSoA_) {
+                LocalResidual::computeFlux(
+                       adres, darcyFlux, globI, globJ, intensiveQuantitiesSoA_, nbInfo.resNBInfo);
+                return;
+            }
+        }
+
+        LocalResidual::computeFlux(
+               adres, darcyFlux, globI, globJ, intQuantsI, intQuantsJ, nbInfo.resNBInfo);
+    }
+
+    // Refresh the parameters of the faces which do not depend on the solution, i.e.,
+    // transmissibilities, threshold pressures, gravity corrections and cell volumes.
     void updateStoredTransmissibilities()
     {
         if (neighborInfo_.empty()) {
@@ -675,7 +905,14 @@ private:
             auto nbInfos = neighborInfo_[globI]; // nbInfos will be a SparseTable<...>::mutable_iterator_range.
             for (auto& nbInfo : nbInfos) {
                 unsigned globJ = nbInfo.neighbor;
-                nbInfo.trans = problem_().transmissibility(globI, globJ);
+                const auto& oldNBInfo = nbInfo.resNBInfo;
+                nbInfo.resNBInfo = LocalResidual::residualNBInfo(problem_(),
+                                                                 globI,
+                                                                 globJ,
+                                                                 problem_().transmissibility(globI, globJ),
+                                                                 oldNBInfo.faceArea,
+                                                                 oldNBInfo.dist,
+                                                                 oldNBInfo.faceDir);
             }
         }
     }
@@ -691,12 +928,11 @@ private:
 
     LinearizationType linearizationType_;
 
+    using ResidualNBInfo = typename LocalResidual::ResidualNBInfo;
     struct NeighborInfo
     {
         unsigned int neighbor;
-        double trans;
-        double faceArea;
-        FaceDir::DirEnum faceDirection;
+        ResidualNBInfo resNBInfo;
         MatrixBlock* matBlockAddress;
     };
     SparseTable<NeighborInfo> neighborInfo_;
@@ -729,6 +965,11 @@ private:
     };
     std::vector<BoundaryInfo> boundaryInfo_;
     bool separateSparseSourceTerms_ = false;
+
+    // copy of the intensive quantities used by the flux terms, see
+    // updateIntensiveQuantitiesSoA_()
+    IntensiveQuantitiesSoA intensiveQuantitiesSoA_;
+    bool enableIntensiveQuantitiesSoA_ = false;
 };
 
 } // namespace Opm
@@ -83,6 +83,15 @@ class P1FeGradientCalculator : public FvBaseGradientCalculator<TypeTag>
 #endif // HAVE_DUNE_LOCALFUNCTIONS
 
 public:
+    /*!
+     * \brief Returns true if the values and gradients at a flux approximation point
+     *        only depend on the two degrees of freedom adjacent to it.
+     *
+     * This is not the case if P1 finite element gradients are used.
+     */
+    static constexpr bool usesTwoPointApproximation()
+    { return !getPropValue<TypeTag, Properties::UseP1FiniteElementGradients>(); }
+
     /*!
      * \brief Precomputes the common values to calculate gradients and
      *        values of quantities at any flux approximation point.
@@ -40,6 +40,9 @@
 
 #include <dune/common/version.hh>
 
+#include <algorithm>
+#include <cassert>
+#include <iterator>
 #include <stdexcept>
 #include <vector>
 
@@ -828,6 +831,38 @@ public:
         }
     }
 
+    /*!
+     * \brief Copy a stencil.
+     *
+     * The geometries of the sub-control volumes of the copy refer to its own element,
+     * so the copy stays valid if the original object goes away. This is, e.g., required
+     * to store the stencils of all elements, see StencilCache.
+     */
+    VcfvStencil(const VcfvStencil& other)
+        : gridView_(other.gridView_)
+        , vertexMapper_(other.vertexMapper_)
+        , element_(other.element_)
+        , elementLocal(other.elementLocal)
+        , elementGlobal(other.elementGlobal)
+        , elementVolume(other.elementVolume)
+        , numBoundarySegments_(other.numBoundarySegments_)
+        , numVertices(other.numVertices)
+        , numEdges(other.numEdges)
+        , numFaces(other.numFaces)
+        , geometryType_(other.geometryType_)
+    {
+        std::copy(std::begin(other.subContVol), std::end(other.subContVol), std::begin(subContVol));
+        std::copy(std::begin(other.subContVolFace), std::end(other.subContVolFace), std::begin(subContVolFace));
+        std::copy(std::begin(other.boundaryFace_), std::end(other.boundaryFace_), std::begin(boundaryFace_));
+        std::copy(std::begin(other.edgeCoord), std::end(other.edgeCoord), std::begin(edgeCoord));
+        std::copy(std::begin(other.faceCoord), std::end(other.faceCoord), std::begin(faceCoord));
+
+        for (auto& scv : subContVol)
+            scv.geometry_.element_ = &element_;
+    }
+
+    VcfvStencil& operator=(const VcfvStencil&) = delete;
+
     /*!
      * \brief Update the non-geometric part of the stencil.
      *
@@ -1015,19 +1050,22 @@ public:
 
     void updateScvGeometry(const Element& element)
     {
+        // the geometries refer to the stencil's own copy of the element because the
+        // entity passed might be a temporary object, e.g., the one of a grid iterator.
+        assert(element == element_);
         auto geomType = element.geometry().type();
 
         // get the local geometries of the sub control volumes
         if (geomType.isTriangle() || geomType.isTetrahedron()) {
             for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx) {
-                subContVol[vertIdx].geometry_.element_ = &element;
+                subContVol[vertIdx].geometry_.element_ = &element_;
                 subContVol[vertIdx].geometry_.localGeometry_ =
                     &VcfvScvGeometries<Scalar, dim, ElementType::simplex>::get(vertIdx);
             }
         }
         else if (geomType.isLine() || geomType.isQuadrilateral() || geomType.isHexahedron()) {
             for (unsigned vertIdx = 0; vertIdx < numVertices; ++vertIdx) {
-                subContVol[vertIdx].geometry_.element_ = &element;
+                subContVol[vertIdx].geometry_.element_ = &element_;
                 subContVol[vertIdx].geometry_.localGeometry_ =
                     &VcfvScvGeometries<Scalar, dim, ElementType::cube>::get(vertIdx);
             }
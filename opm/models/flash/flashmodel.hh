@@ -239,12 +239,31 @@ public:
                              "consider the solution converged");
     }
 
+    /*!
+     * \copydoc FvBaseDiscretization::finishInit()
+     */
+    void finishInit()
+    {
+        // the tolerance is required by the intensive quantities, so it must be known
+        // before they are computed for the first time
+        flashTolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, FlashTolerance);
+
+        ParentType::finishInit();
+    }
+
     /*!
      * \copydoc FvBaseDiscretization::name
      */
     static std::string name()
     { return "flash"; }
 
+    /*!
+     * \brief Returns the maximum tolerance for the flash solver to consider the
+     *        solution converged.
+     */
+    Scalar flashTolerance() const
+    { return flashTolerance_; }
+
     /*!
      * \copydoc FvBaseDiscretization::primaryVarName
      */
@@ -331,6 +350,9 @@ public:
         if (enableEnergy)
             this->addOutputModule(new Opm::VtkEnergyModule<TypeTag>(this->simulator_));
     }
+
+private:
+    Scalar flashTolerance_ = 0.0;
 };
 
 } // namespace Opm
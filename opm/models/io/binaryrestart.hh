@@ -0,0 +1,831 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BinaryRestart
+ */
+#ifndef EWOMS_BINARY_RESTART_HH
+#define EWOMS_BINARY_RESTART_HH
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <locale>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Opm {
+
+/*!
+ * \brief Load or save a state of a problem to/from the harddisk using a binary file
+ *        format.
+ *
+ * This class provides the same interface as Opm::Restart, so the serializeEntity() and
+ * deserializeEntity() methods of the models can be used unmodified: The streams which
+ * are passed to them use a locale whose numeric facets write the raw bytes of
+ * arithmetic values (prefixed by a tag which denotes the kind of value) instead of
+ * formatting them as text. Everything else which is written to the streams (e.g.,
+ * separators or strings) is stored verbatim.
+ *
+ * Each process writes a separate file. It starts with a header that contains the
+ * metadata of the grid and is followed by the sections of the file. Each section
+ * stores its size and a checksum of its payload, which is verified before anything is
+ * read from it. For reading, the file is mapped into memory.
+ */
+class BinaryRestart
+{
+    static constexpr std::uint32_t formatVersion_ = 1;
+    static constexpr std::uint32_t byteOrderMark_ = 0x01020304;
+    static constexpr std::uint32_t sectionMagic_ = 0x54434553; // "SECT"
+
+    // the tags which prefix the raw bytes of arithmetic values. these are printable
+    // non-whitespace characters, so the whitespace skipping done by std::istream
+    // stops at them
+    static constexpr char boolTag_ = 'B';
+    static constexpr char signedTag_ = 'I';
+    static constexpr char unsignedTag_ = 'U';
+    static constexpr char doubleTag_ = 'D';
+    static constexpr char longDoubleTag_ = 'L';
+
+    struct Header_
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrderMark;
+        std::int64_t numRanks;
+        std::int64_t rank;
+        std::int64_t numElements;
+        std::int64_t numEdges;
+        std::int64_t numVertices;
+        std::int64_t gridSequenceNumber;
+        double time;
+        std::uint64_t checksum; // of all fields above
+    };
+    static_assert(std::is_trivially_copyable<Header_>::value,
+                  "The header of binary restart files must be trivially copyable");
+
+    /*!
+     * \brief A simple, word based 64 bit checksum which can be updated
+     *        incrementally.
+     */
+    class Checksum_
+    {
+    public:
+        void update(const char* data, std::size_t n)
+        {
+            const auto* p = reinterpret_cast<const unsigned char*>(data);
+            length_ += n;
+
+            // complete a partially filled word
+            for (; tailLen_ > 0 && n > 0; --n)
+                addByte_(*p++);
+
+            for (; n >= 8; n -= 8, p += 8) {
+                std::uint64_t w = 0;
+                for (unsigned i = 0; i < 8; ++i)
+                    w |= static_cast<std::uint64_t>(p[i]) << (8*i);
+                state_ = mix_(state_, w);
+            }
+
+            for (; n > 0; --n)
+                addByte_(*p++);
+        }
+
+        std::uint64_t value() const
+        {
+            std::uint64_t h = state_;
+            if (tailLen_ > 0)
+                h = mix_(h, tail_);
+            return mix_(h, length_);
+        }
+
+    private:
+        void addByte_(unsigned char c)
+        {
+            tail_ |= static_cast<std::uint64_t>(c) << (8*tailLen_);
+            if (++tailLen_ == 8) {
+                state_ = mix_(state_, tail_);
+                tail_ = 0;
+                tailLen_ = 0;
+            }
+        }
+
+        static std::uint64_t mix_(std::uint64_t h, std::uint64_t w)
+        {
+            h = (h ^ w)*0x9e3779b97f4a7c15ULL;
+            return h ^ (h >> 32);
+        }
+
+        std::uint64_t state_ = 0xcbf29ce484222325ULL;
+        std::uint64_t tail_ = 0;
+        std::uint64_t length_ = 0;
+        unsigned tailLen_ = 0;
+    };
+
+    /*!
+     * \brief Writes the raw bytes of arithmetic values instead of their textual
+     *        representation.
+     */
+    class NumPut_ : public std::num_put<char>
+    {
+    protected:
+        iter_type do_put(iter_type out, std::ios_base&, char, bool v) const override
+        { return write_(out, boolTag_, static_cast<unsigned char>(v)); }
+        iter_type do_put(iter_type out, std::ios_base&, char, long v) const override
+        { return write_(out, signedTag_, static_cast<std::int64_t>(v)); }
+        iter_type do_put(iter_type out, std::ios_base&, char, long long v) const override
+        { return write_(out, signedTag_, static_cast<std::int64_t>(v)); }
+        iter_type do_put(iter_type out, std::ios_base&, char, unsigned long v) const override
+        { return write_(out, unsignedTag_, static_cast<std::uint64_t>(v)); }
+        iter_type do_put(iter_type out, std::ios_base&, char, unsigned long long v) const override
+        { return write_(out, unsignedTag_, static_cast<std::uint64_t>(v)); }
+        iter_type do_put(iter_type out, std::ios_base&, char, double v) const override
+        { return write_(out, doubleTag_, v); }
+        iter_type do_put(iter_type out, std::ios_base&, char, long double v) const override
+        { return write_(out, longDoubleTag_, v); }
+
+    private:
+        template <class T>
+        static iter_type write_(iter_type out, char tag, const T& value)
+        {
+            char buf[sizeof(T)];
+            std::memcpy(buf, &value, sizeof(T));
+
+            *out++ = tag;
+            for (unsigned i = 0; i < sizeof(T); ++i)
+                *out++ = buf[i];
+            return out;
+        }
+    };
+
+    /*!
+     * \brief Reads the values written by NumPut_.
+     *
+     * Values can be read into a different type than the one they were written from as
+     * long as the conversion is exact for integers.
+     */
+    class NumGet_ : public std::num_get<char>
+    {
+    protected:
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, bool& v) const override
+        { return read_(in, end, err, v); }
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, long& v) const override
+        { return read_(in, end, err, v); }
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, long long& v) const override
+        { return read_(in, end, err, v); }
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, unsigned short& v) const override
+        { return read_(in, end, err, v); }
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, unsigned int& v) const override
+        { return read_(in, end, err, v); }
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, unsigned long& v) const override
+        { return read_(in, end, err, v); }
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, unsigned long long& v) const override
+        { return read_(in, end, err, v); }
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, float& v) const override
+        { return read_(in, end, err, v); }
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, double& v) const override
+        { return read_(in, end, err, v); }
+        iter_type do_get(iter_type in, iter_type end, std::ios_base&,
+                         std::ios_base::iostate& err, long double& v) const override
+        { return read_(in, end, err, v); }
+
+    private:
+        template <class T>
+        static iter_type read_(iter_type in, iter_type end, std::ios_base::iostate& err, T& v)
+        {
+            if (in == end) {
+                err |= std::ios_base::eofbit | std::ios_base::failbit;
+                return in;
+            }
+
+            const char tag = *in;
+            ++in;
+
+            bool ok = false;
+            switch (tag) {
+            case boolTag_: {
+                unsigned char x;
+                ok = readRaw_(in, end, x) && convert_(static_cast<std::uint64_t>(x), v);
+                break;
+            }
+            case signedTag_: {
+                std::int64_t x;
+                ok = readRaw_(in, end, x) && convert_(x, v);
+                break;
+            }
+            case unsignedTag_: {
+                std::uint64_t x;
+                ok = readRaw_(in, end, x) && convert_(x, v);
+                break;
+            }
+            case doubleTag_: {
+                double x;
+                ok = readRaw_(in, end, x) && convert_(x, v);
+                break;
+            }
+            case longDoubleTag_: {
+                long double x;
+                ok = readRaw_(in, end, x) && convert_(x, v);
+                break;
+            }
+            default:
+                break;
+            }
+
+            // in contrast to the textual representation, reaching the end of the data
+            // after a value was read completely is not an error
+            if (!ok) {
+                err |= std::ios_base::failbit;
+                if (in == end)
+                    err |= std::ios_base::eofbit;
+            }
+            return in;
+        }
+
+        template <class T>
+        static bool readRaw_(iter_type& in, const iter_type& end, T& value)
+        {
+            char buf[sizeof(T)];
+            for (unsigned i = 0; i < sizeof(T); ++i, ++in) {
+                if (in == end)
+                    return false;
+                buf[i] = *in;
+            }
+            std::memcpy(&value, buf, sizeof(T));
+            return true;
+        }
+
+        template <class Source, class Target>
+        static bool convert_(Source x, Target& v)
+        {
+            if constexpr (std::is_floating_point<Target>::value) {
+                v = static_cast<Target>(x);
+                return true;
+            }
+            else if constexpr (std::is_floating_point<Source>::value)
+                return false; // floating point values cannot be read into integers
+            else {
+                // integer conversions must be exact
+                if constexpr (std::is_signed<Source>::value && !std::is_signed<Target>::value) {
+                    if (x < 0)
+                        return false;
+                }
+
+                Target y = static_cast<Target>(x);
+                if constexpr (!std::is_signed<Source>::value && std::is_signed<Target>::value) {
+                    if (y < 0)
+                        return false;
+                }
+
+                if (static_cast<Source>(y) != x)
+                    return false;
+
+                v = y;
+                return true;
+            }
+        }
+    };
+
+    /*!
+     * \brief A stream buffer which forwards everything to a file and keeps track of
+     *        the number of bytes written and their checksum.
+     */
+    class ChecksumOutBuf_ : public std::streambuf
+    {
+    public:
+        explicit ChecksumOutBuf_(std::streambuf& target)
+            : target_(target)
+            , buffer_(1 << 16)
+        { setp(buffer_.data(), buffer_.data() + buffer_.size()); }
+
+        void reset()
+        {
+            flush_();
+            checksum_ = Checksum_();
+            numBytes_ = 0;
+        }
+
+        std::uint64_t numBytes() const
+        { return numBytes_ + static_cast<std::uint64_t>(pptr() - pbase()); }
+
+        std::uint64_t checksum()
+        {
+            flush_();
+            return checksum_.value();
+        }
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            if (!flush_())
+                return traits_type::eof();
+
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(c);
+                pbump(1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override
+        {
+            if (n > epptr() - pptr()) {
+                if (!flush_())
+                    return 0;
+
+                // large blocks are directly forwarded to the file
+                if (n >= static_cast<std::streamsize>(buffer_.size())) {
+                    checksum_.update(s, static_cast<std::size_t>(n));
+                    numBytes_ += static_cast<std::uint64_t>(n);
+                    return target_.sputn(s, n);
+                }
+            }
+
+            std::memcpy(pptr(), s, static_cast<std::size_t>(n));
+            pbump(static_cast<int>(n));
+            return n;
+        }
+
+        int sync() override
+        { return flush_() ? 0 : -1; }
+
+    private:
+        bool flush_()
+        {
+            const std::streamsize n = pptr() - pbase();
+            if (n == 0)
+                return true;
+
+            checksum_.update(pbase(), static_cast<std::size_t>(n));
+            numBytes_ += static_cast<std::uint64_t>(n);
+            setp(buffer_.data(), buffer_.data() + buffer_.size());
+            return target_.sputn(buffer_.data(), n) == n;
+        }
+
+        std::streambuf& target_;
+        std::vector<char> buffer_;
+        Checksum_ checksum_;
+        std::uint64_t numBytes_ = 0;
+    };
+
+    /*!
+     * \brief A stream buffer which reads directly from a memory range.
+     */
+    class MemoryInBuf_ : public std::streambuf
+    {
+    public:
+        void setRange(const char* begin, const char* end)
+        {
+            // the get area is never written to
+            char* b = const_cast<char*>(begin);
+            char* e = const_cast<char*>(end);
+            setg(b, b, e);
+        }
+
+        const char* position() const
+        { return gptr(); }
+
+        const char* end() const
+        { return egptr(); }
+    };
+
+    /*!
+     * \brief Returns a locale that uses the binary representation for numeric values.
+     */
+    static std::locale binaryLocale_()
+    {
+        std::locale tmp(std::locale::classic(), new NumPut_);
+        return std::locale(tmp, new NumGet_);
+    }
+
+    /*!
+     * \brief Return the restart file name.
+     */
+    template <class GridView, class Scalar>
+    static const std::string restartFileName_(const GridView& gridView,
+                                              const std::string& outputDir,
+                                              const std::string& simName,
+                                              Scalar t)
+    {
+        std::string dir = outputDir;
+        if (dir == ".")
+            dir = "";
+        else if (!dir.empty() && dir.back() != '/')
+            dir += "/";
+
+        int rank = gridView.comm().rank();
+        std::ostringstream oss;
+        oss << dir << simName << "_time=" << t << "_rank=" << rank << ".erb";
+        return oss.str();
+    }
+
+    /*!
+     * \brief Create the header of a restart file for the current state of the
+     *        simulator.
+     */
+    template <class Simulator>
+    static Header_ makeHeader_(const Simulator& simulator, double t)
+    {
+        const auto& gridView = simulator.gridView();
+        static const int dim = std::decay_t<decltype(gridView)>::dimension;
+
+        Header_ header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "OPMBRST", 8);
+        header.version = formatVersion_;
+        header.byteOrderMark = byteOrderMark_;
+        header.numRanks = gridView.comm().size();
+        header.rank = gridView.comm().rank();
+        header.numElements = gridView.size(0);
+        header.numEdges = gridView.size(dim - 1);
+        header.numVertices = gridView.size(dim);
+        header.gridSequenceNumber = simulator.vanguard().gridSequenceNumber();
+        header.time = t;
+        header.checksum = headerChecksum_(header);
+        return header;
+    }
+
+    static std::uint64_t headerChecksum_(const Header_& header)
+    {
+        Checksum_ checksum;
+        checksum.update(reinterpret_cast<const char*>(&header), offsetof(Header_, checksum));
+        return checksum.value();
+    }
+
+public:
+    BinaryRestart()
+        : outBuf_(fileBuf_)
+        , outStream_(&outBuf_)
+        , inStream_(&inBuf_)
+    {
+        outStream_.imbue(binaryLocale_());
+        inStream_.imbue(binaryLocale_());
+    }
+
+    BinaryRestart(const BinaryRestart&) = delete;
+    BinaryRestart& operator=(const BinaryRestart&) = delete;
+
+    ~BinaryRestart()
+    { unmap_(); }
+
+    /*!
+     * \brief Returns the name of the file which is (de-)serialized.
+     */
+    const std::string& fileName() const
+    { return fileName_; }
+
+    /*!
+     * \brief Write the current state of the model to disk.
+     */
+    template <class Simulator>
+    void serializeBegin(Simulator& simulator)
+    {
+        fileName_ = restartFileName_(simulator.gridView(),
+                                     simulator.problem().outputDir(),
+                                     simulator.problem().name(),
+                                     simulator.time());
+
+        if (!fileBuf_.open(fileName_, std::ios::out | std::ios::binary | std::ios::trunc))
+            throw std::runtime_error("Restart file '"+fileName_+"' could not be opened for writing");
+
+        writeRaw_(makeHeader_(simulator, simulator.time()));
+        sectionOpen_ = false;
+    }
+
+    /*!
+     * \brief The output stream to write the serialized data.
+     */
+    std::ostream& serializeStream()
+    { return outStream_; }
+
+    /*!
+     * \brief Start a new section in the serialized output.
+     */
+    void serializeSectionBegin(const std::string& cookie)
+    {
+        if (sectionOpen_)
+            throw std::logic_error("Section '"+cookie+"' started before the previous one was ended");
+
+        writeRaw_(sectionMagic_);
+        writeRaw_(static_cast<std::uint32_t>(cookie.size()));
+        writeBytes_(cookie.data(), cookie.size());
+
+        // the size and the checksum of the payload are only known at the end of the
+        // section
+        sectionInfoPos_ = fileBuf_.pubseekoff(0, std::ios::cur, std::ios::out);
+        writeRaw_(std::uint64_t(0));
+        writeRaw_(std::uint64_t(0));
+
+        outBuf_.reset();
+        outStream_.clear();
+        sectionOpen_ = true;
+    }
+
+    /*!
+     * \brief End of a section in the serialized output.
+     */
+    void serializeSectionEnd()
+    {
+        outStream_.flush();
+        if (!outStream_.good())
+            throw std::runtime_error("Could not write to restart file '"+fileName_+"'");
+
+        const std::uint64_t numBytes = outBuf_.numBytes();
+        const std::uint64_t checksum = outBuf_.checksum();
+
+        const auto endPos = fileBuf_.pubseekoff(0, std::ios::cur, std::ios::out);
+        fileBuf_.pubseekpos(sectionInfoPos_, std::ios::out);
+        writeRaw_(numBytes);
+        writeRaw_(checksum);
+        fileBuf_.pubseekpos(endPos, std::ios::out);
+
+        sectionOpen_ = false;
+    }
+
+    /*!
+     * \brief Serialize all leaf entities of a codim in a gridView.
+     *
+     * The actual work is done by Serializer::serialize(Entity)
+     */
+    template <int codim, class Serializer, class GridView>
+    void serializeEntities(Serializer& serializer, const GridView& gridView)
+    {
+        std::ostringstream oss;
+        oss << "Entities: Codim " << codim;
+        serializeSectionBegin(oss.str());
+
+        outStream_ << static_cast<std::uint64_t>(gridView.size(codim));
+
+        using Iterator = typename GridView::template Codim<codim>::Iterator;
+
+        Iterator it = gridView.template begin<codim>();
+        const Iterator& endIt = gridView.template end<codim>();
+        for (; it != endIt; ++it)
+            serializer.serializeEntity(outStream_, *it);
+
+        serializeSectionEnd();
+    }
+
+    /*!
+     * \brief Finish the restart file.
+     */
+    void serializeEnd()
+    {
+        if (!fileBuf_.close())
+            throw std::runtime_error("Could not finish restart file '"+fileName_+"'");
+    }
+
+    /*!
+     * \brief Start reading a restart file at a certain simulated
+     *        time.
+     */
+    template <class Simulator, class Scalar>
+    void deserializeBegin(Simulator& simulator, Scalar t)
+    {
+        fileName_ = restartFileName_(simulator.gridView(), simulator.problem().outputDir(), simulator.problem().name(), t);
+
+        int fd = ::open(fileName_.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+
+        struct stat fileStat;
+        if (::fstat(fd, &fileStat) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Could not determine the size of restart file '"+fileName_+"'");
+        }
+
+        // make sure that we don't open an empty file
+        if (fileStat.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("Restart file '"+fileName_+"' is empty");
+        }
+
+        mapSize_ = static_cast<std::size_t>(fileStat.st_size);
+        void* addr = ::mmap(nullptr, mapSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            mapSize_ = 0;
+            throw std::runtime_error("Restart file '"+fileName_+"' could not be mapped into memory");
+        }
+        mapData_ = static_cast<const char*>(addr);
+        ::madvise(addr, mapSize_, MADV_SEQUENTIAL);
+        readPos_ = 0;
+
+        const Header_ header = readMapped_<Header_>();
+        const Header_ expected = makeHeader_(simulator, static_cast<double>(t));
+        if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0)
+            throw std::runtime_error("File '"+fileName_+"' is not a binary restart file");
+        if (header.byteOrderMark != expected.byteOrderMark)
+            throw std::runtime_error("Restart file '"+fileName_+"' was written on a machine "
+                                     "with a different byte order");
+        if (header.version != expected.version)
+            throw std::runtime_error("Restart file '"+fileName_+"' uses an unsupported version "
+                                     "of the file format");
+        if (header.checksum != headerChecksum_(header))
+            throw std::runtime_error("Header of restart file '"+fileName_+"' is corrupted");
+
+        // the grid sequence number and the time are only informative. the time is
+        // already encoded in the file name and the sequence number depends on how
+        // the grid was created
+        if (header.numRanks != expected.numRanks
+            || header.rank != expected.rank
+            || header.numElements != expected.numElements
+            || header.numEdges != expected.numEdges
+            || header.numVertices != expected.numVertices)
+        {
+            std::ostringstream oss;
+            oss << "Restart file '" << fileName_ << "' does not match the grid: "
+                << "numCPUs=" << header.numRanks << " "
+                << "myRank=" << header.rank << " "
+                << "numElements=" << header.numElements << " "
+                << "numEdges=" << header.numEdges << " "
+                << "numVertices=" << header.numVertices;
+            throw std::runtime_error(oss.str());
+        }
+    }
+
+    /*!
+     * \brief The input stream to read the data which ought to be
+     *        deserialized.
+     */
+    std::istream& deserializeStream()
+    { return inStream_; }
+
+    /*!
+     * \brief Start reading a new section of the restart file.
+     */
+    void deserializeSectionBegin(const std::string& cookie)
+    {
+        if (readPos_ + sizeof(sectionMagic_) > mapSize_)
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+        if (readMapped_<std::uint32_t>() != sectionMagic_)
+            throw std::runtime_error("Restart file is corrupted");
+
+        const auto cookieLen = readMapped_<std::uint32_t>();
+        if (readPos_ + cookieLen > mapSize_
+            || cookie.size() != cookieLen
+            || std::memcmp(cookie.data(), mapData_ + readPos_, cookieLen) != 0)
+            throw std::runtime_error("Could not start section '"+cookie+"'");
+        readPos_ += cookieLen;
+
+        const auto numBytes = readMapped_<std::uint64_t>();
+        const auto checksum = readMapped_<std::uint64_t>();
+        if (numBytes > mapSize_ - readPos_)
+            throw std::runtime_error("Section '"+cookie+"' of the restart file is truncated");
+
+        const char* payload = mapData_ + readPos_;
+        Checksum_ payloadChecksum;
+        payloadChecksum.update(payload, numBytes);
+        if (payloadChecksum.value() != checksum)
+            throw std::runtime_error("Checksum mismatch in section '"+cookie+"' of the restart file");
+
+        inBuf_.setRange(payload, payload + numBytes);
+        inStream_.clear();
+        readPos_ += numBytes;
+    }
+
+    /*!
+     * \brief End of a section in the serialized output.
+     */
+    void deserializeSectionEnd()
+    {
+        for (const char* p = inBuf_.position(); p != inBuf_.end(); ++p) {
+            if (!std::isspace(static_cast<unsigned char>(*p))) {
+                throw std::logic_error("Encountered unread values while deserializing");
+            }
+        }
+    }
+
+    /*!
+     * \brief Deserialize all leaf entities of a codim in a grid.
+     *
+     * The actual work is done by Deserializer::deserialize(Entity)
+     */
+    template <int codim, class Deserializer, class GridView>
+    void deserializeEntities(Deserializer& deserializer, const GridView& gridView)
+    {
+        std::ostringstream oss;
+        oss << "Entities: Codim " << codim;
+        deserializeSectionBegin(oss.str());
+
+        std::uint64_t numEntities = 0;
+        inStream_ >> numEntities;
+        if (!inStream_ || numEntities != static_cast<std::uint64_t>(gridView.size(codim)))
+            throw std::runtime_error("Restart file is corrupted");
+
+        using Iterator = typename GridView::template Codim<codim>::Iterator;
+        Iterator it = gridView.template begin<codim>();
+        const Iterator& endIt = gridView.template end<codim>();
+        for (; it != endIt; ++it) {
+            if (inStream_.fail()) {
+                throw std::runtime_error("Restart file is corrupted");
+            }
+
+            deserializer.deserializeEntity(inStream_, *it);
+        }
+
+        if (inStream_.fail())
+            throw std::runtime_error("Restart file is corrupted");
+
+        deserializeSectionEnd();
+    }
+
+    /*!
+     * \brief Stop reading the restart file.
+     */
+    void deserializeEnd()
+    { unmap_(); }
+
+private:
+    template <class T>
+    void writeRaw_(const T& value)
+    { writeBytes_(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+    void writeBytes_(const char* data, std::size_t n)
+    {
+        const auto count = static_cast<std::streamsize>(n);
+        if (fileBuf_.sputn(data, count) != count)
+            throw std::runtime_error("Could not write to restart file '"+fileName_+"'");
+    }
+
+    template <class T>
+    T readMapped_()
+    {
+        if (readPos_ + sizeof(T) > mapSize_)
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+
+        T value;
+        std::memcpy(&value, mapData_ + readPos_, sizeof(T));
+        readPos_ += sizeof(T);
+        return value;
+    }
+
+    void unmap_()
+    {
+        if (mapData_) {
+            ::munmap(const_cast<char*>(mapData_), mapSize_);
+            mapData_ = nullptr;
+            mapSize_ = 0;
+        }
+        inBuf_.setRange(nullptr, nullptr);
+    }
+
+    std::string fileName_;
+
+    std::filebuf fileBuf_;
+    ChecksumOutBuf_ outBuf_;
+    std::ostream outStream_;
+    std::streampos sectionInfoPos_;
+    bool sectionOpen_ = false;
+
+    const char* mapData_ = nullptr;
+    std::size_t mapSize_ = 0;
+    std::size_t readPos_ = 0;
+    MemoryInBuf_ inBuf_;
+    std::istream inStream_;
+};
+} // namespace Opm
+
+#endif
@@ -82,45 +82,21 @@ protected:
     friend ParentType;
     friend NewtonMethod<TypeTag>;
 
-    void preSolve_(const SolutionVector&,
-                   const GlobalEqVector& currentResidual)
+    /*!
+     * \copydoc NewtonMethod::dofError_
+     *
+     * The NCP equations are not considered for the error.
+     */
+    Scalar dofError_(unsigned dofIdx, const EqVector& r) const
     {
-        const auto& constraintsMap = this->model().linearizer().constraintsMap();
-        this->lastError_ = this->error_;
-
-        // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
-        this->error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= this->model().numGridDof() || this->model().dofTotalVolume(dofIdx) <= 0.0)
+        Scalar result = 0.0;
+        for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
+            if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
                 continue;
-
-            // also do not consider DOFs which are constraint
-            if (this->enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
-                    continue;
-            }
-
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
-                if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
-                    continue;
-                this->error_ =
-                    std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
-                             this->error_);
-            }
+            result = std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
+                              result);
         }
-
-        // take the other processes into account
-        this->error_ = this->comm_.max(this->error_);
-
-        // make sure that the error never grows beyond the maximum
-        // allowed one
-        if (this->error_ > EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))
-            throw Opm::NumericalProblem("Newton: Error "+std::to_string(double(this->error_))+
-                                        + " is larger than maximum allowed error of "
-                                        + std::to_string(double(EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError))));
+        return result;
     }
 
     /*!
@@ -36,6 +36,7 @@
 #include <opm/material/densead/Math.hpp>
 
 #include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/profiler.hh>
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 
@@ -45,8 +46,14 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <algorithm>
+#include <exception>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <unistd.h>
 
@@ -97,6 +104,16 @@ template<class TypeTag>
 struct NewtonTargetIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 10; };
 template<class TypeTag>
 struct NewtonMaxIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 20; };
+template<class TypeTag>
+struct NewtonJacobianStrategy<TypeTag, TTag::NewtonMethod> { static constexpr auto value = "full"; };
+template<class TypeTag>
+struct NewtonFrozenJacobianMaxContraction<TypeTag, TTag::NewtonMethod>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 0.25;
+};
+template<class TypeTag>
+struct NewtonMaxFrozenJacobianIterations<TypeTag, TTag::NewtonMethod> { static constexpr int value = 2; };
 
 } // namespace Opm::Properties
 
@@ -142,6 +159,15 @@ public:
         tolerance_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonTolerance);
 
         numIterations_ = 0;
+
+        const std::string jacobianStrategy = EWOMS_GET_PARAM(TypeTag, std::string, NewtonJacobianStrategy);
+        if (jacobianStrategy == "frozen")
+            frozenJacobian_ = true;
+        else if (jacobianStrategy != "full")
+            throw std::invalid_argument("Unknown Jacobian strategy for the Newton method: '"
+                                        + jacobianStrategy + "'");
+        frozenJacobianMaxContraction_ = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonFrozenJacobianMaxContraction);
+        maxFrozenJacobianIterations_ = EWOMS_GET_PARAM(TypeTag, int, NewtonMaxFrozenJacobianIterations);
     }
 
     /*!
@@ -170,6 +196,18 @@ public:
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonMaxError,
                              "The maximum error tolerated by the Newton "
                              "method to which does not cause an abort");
+        EWOMS_REGISTER_PARAM(TypeTag, std::string, NewtonJacobianStrategy,
+                             "How the Jacobian matrix is obtained in each Newton "
+                             "iteration. Valid values are 'full' and 'frozen' which "
+                             "only evaluates the residual and keeps the previous "
+                             "Jacobian matrix while the error contracts fast enough");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, NewtonFrozenJacobianMaxContraction,
+                             "The maximum ratio between the errors of two consecutive "
+                             "Newton iterations for which the 'frozen' Jacobian "
+                             "strategy reuses the Jacobian matrix");
+        EWOMS_REGISTER_PARAM(TypeTag, int, NewtonMaxFrozenJacobianIterations,
+                             "The maximum number of consecutive Newton iterations "
+                             "which reuse the same Jacobian matrix");
     }
 
     /*!
@@ -288,6 +326,10 @@ public:
             // execute the method as long as the implementation thinks
             // that we should do another iteration
             while (asImp_().proceed_()) {
+                // the profile of the previous iteration is complete at this point
+                EWOMS_PROFILE_FLUSH(simulator_.timeStepIndex(), numIterations_ - 1);
+                EWOMS_PROFILE_SCOPE("newton_iteration");
+
                 // linearize the problem at the current solution
 
                 // notify the implementation that we're about to start
@@ -305,27 +347,58 @@ public:
                               << std::flush;
                 }
 
+                // decide whether the Jacobian matrix of a previous iteration is kept
+                const bool reuseJacobian = asImp_().reuseJacobian_();
+
                 // do the actual linearization
                 linearizeTimer_.start();
-                asImp_().linearizeDomain_();
-                asImp_().linearizeAuxiliaryEquations_();
+                if (reuseJacobian) {
+                    EWOMS_PROFILE_SCOPE("linearize_residual");
+                    EWOMS_PROFILE_COUNT("frozen_jacobian", 1);
+                    asImp_().linearizeDomainResidual_();
+                    ++numFrozenJacobianIterations_;
+                    endIterMsg() << ", frozen Jacobian";
+                }
+                else {
+                    {
+                        EWOMS_PROFILE_SCOPE("linearize");
+                        asImp_().linearizeDomain_();
+                    }
+                    {
+                        EWOMS_PROFILE_SCOPE("linearize_auxiliary");
+                        asImp_().linearizeAuxiliaryEquations_();
+                    }
+                    jacobianIsReusable_ = true;
+                    numFrozenJacobianIterations_ = 0;
+                }
                 linearizeTimer_.stop();
 
                 solveTimer_.start();
                 auto& residual = linearizer.residual();
                 const auto& jacobian = linearizer.jacobian();
-                linearSolver_.prepare(jacobian, residual);
-                linearSolver_.setResidual(residual);
-                linearSolver_.getResidual(residual);
+                {
+                    EWOMS_PROFILE_SCOPE("linear_solver_setup");
+                    linearSolver_.prepare(jacobian, residual);
+                    linearSolver_.setResidual(residual);
+                    linearSolver_.getResidual(residual);
+                }
                 solveTimer_.stop();
 
                 // The preSolve_() method usually computes the errors, but it can do
                 // something else in addition. TODO: should its costs be counted to
                 // the linearization or to the update?
                 updateTimer_.start();
-                asImp_().preSolve_(currentSolution, residual);
+                {
+                    EWOMS_PROFILE_SCOPE("pre_solve");
+                    asImp_().preSolve_(currentSolution, residual);
+                }
                 updateTimer_.stop();
 
+                // the contraction of the error decides whether the Jacobian matrix can
+                // be reused by the next iteration
+                if (numIterations_ > 0 && lastError_ > 0.0)
+                    errorContraction_ = error_/lastError_;
+
                 if (!asImp_().proceed_()) {
                     if (asImp_().verbose_() && isatty(fileno(stdout)))
                         std::cout << clearRemainingLine
@@ -349,9 +422,16 @@ public:
                 solveTimer_.start();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
                 // update of the solution
-                linearSolver_.setMatrix(jacobian);
-                solutionUpdate = 0.0;
-                bool converged = linearSolver_.solve(solutionUpdate);
+                bool converged;
+                {
+                    EWOMS_PROFILE_SCOPE("linear_solve");
+                    // if the matrix is not set again, the linear solver also keeps
+                    // the preconditioner of the previous iteration
+                    if (!reuseJacobian)
+                        linearSolver_.setMatrix(jacobian);
+                    solutionUpdate = 0.0;
+                    converged = linearSolver_.solve(solutionUpdate);
+                }
                 solveTimer_.stop();
 
                 if (!converged) {
@@ -376,10 +456,13 @@ public:
                 // update the current solution (i.e. uOld) with the delta
                 // (i.e. u). The result is stored in u
                 updateTimer_.start();
-                asImp_().postSolve_(currentSolution,
-                                    residual,
-                                    solutionUpdate);
-                asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                {
+                    EWOMS_PROFILE_SCOPE("update");
+                    asImp_().postSolve_(currentSolution,
+                                        residual,
+                                        solutionUpdate);
+                    asImp_().update_(nextSolution, currentSolution, solutionUpdate, residual);
+                }
                 updateTimer_.stop();
 
                 if (asImp_().verbose_() && isatty(fileno(stdout)))
@@ -418,6 +501,8 @@ public:
             return false;
         }
 
+        EWOMS_PROFILE_FLUSH(simulator_.timeStepIndex(), numIterations_ - 1);
+
         // clear current line on terminal
         if (asImp_().verbose_() && isatty(fileno(stdout)))
             std::cout << clearRemainingLine
@@ -532,7 +617,7 @@ protected:
      */
     bool verbose_() const
     {
-        return EWOMS_GET_PARAM(TypeTag, bool, NewtonVerbose) && (comm_.rank() == 0);
+        return EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonVerbose) && (comm_.rank() == 0);
     }
 
     /*!
@@ -545,7 +630,12 @@ protected:
     {
         numIterations_ = 0;
 
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
+        // the Jacobian matrix of the previous time step is never reused
+        jacobianIsReusable_ = false;
+        numFrozenJacobianIterations_ = 0;
+        errorContraction_ = 1.0;
+
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.beginTimeStep();
     }
 
@@ -586,6 +676,37 @@ protected:
         model().linearizer().linearizeDomain();
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain without updating the Jacobian
+     *        matrix.
+     */
+    void linearizeDomainResidual_()
+    {
+        model().linearizer().linearizeDomainResidual();
+    }
+
+    /*!
+     * \brief Returns true if the next iteration only evaluates the residual and keeps
+     *        the Jacobian matrix of a previous iteration.
+     *
+     * This is only done by the "frozen" Jacobian strategy if the error of the last
+     * iteration contracted at least by the configured factor and the Jacobian matrix
+     * has not been reused too often already.
+     */
+    bool reuseJacobian_() const
+    {
+        if (!frozenJacobian_ || !jacobianIsReusable_)
+            return false;
+
+        if (numFrozenJacobianIterations_ >= maxFrozenJacobianIterations_)
+            return false;
+
+        if (!model().linearizer().supportsResidualOnlyLinearization())
+            return false;
+
+        return errorContraction_ <= frozenJacobianMaxContraction_;
+    }
+
     void linearizeAuxiliaryEquations_()
     {
         model().linearizer().linearizeAuxiliaryEquations();
@@ -595,27 +716,43 @@ protected:
     void preSolve_(const SolutionVector&,
                    const GlobalEqVector& currentResidual)
     {
-        const auto& constraintsMap = model().linearizer().constraintsMap();
         lastError_ = error_;
-        Scalar newtonMaxError = EWOMS_GET_PARAM(TypeTag, Scalar, NewtonMaxError);
+        Scalar newtonMaxError = EWOMS_GET_CACHED_PARAM(TypeTag, Scalar, NewtonMaxError);
+
+        // the constraints are only updated by the linearization, so the flags
+        // are also valid for the update of the solution. they are only rebuilt if
+        // the linearizer has changed its constraints map.
+        updateConstraintFlags_();
 
         // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
+        // the solution's residual. auxiliary DOFs are not considered.
         error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
+        const long numDof = static_cast<long>(std::min<std::size_t>(currentResidual.size(),
+                                                                    model().numGridDof()));
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Scalar threadError = 0.0;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+            for (long i = 0; i < numDof; ++i) {
+                const unsigned dofIdx = static_cast<unsigned>(i);
+                if (model().dofTotalVolume(dofIdx) <= 0.0)
+                    continue;
+
+                // also do not consider DOFs which are constraint
+                if (enableConstraints_() && isConstraintDof_[dofIdx])
                     continue;
+
+                threadError = max(asImp_().dofError_(dofIdx, currentResidual[dofIdx]), threadError);
             }
 
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+            error_ = max(threadError, error_);
         }
 
         // take the other processes into account
@@ -629,6 +766,19 @@ protected:
                                    + std::to_string(double(newtonMaxError)));
     }
 
+    /*!
+     * \brief Returns the contribution of a single degree of freedom to the error.
+     *
+     * This method is called concurrently for different degrees of freedom.
+     */
+    Scalar dofError_(unsigned dofIdx, const EqVector& r) const
+    {
+        Scalar result = 0.0;
+        for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
+            result = max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), result);
+        return result;
+    }
+
     /*!
      * \brief Update the error of the solution given the previous
      *        iteration.
@@ -696,19 +846,36 @@ protected:
         // analysis possible
         asImp_().writeConvergence_(currentSolution, solutionUpdate);
 
-        // make sure not to swallow non-finite values at this point
-        if (!std::isfinite(solutionUpdate.one_norm()))
+        // make sure not to swallow non-finite values at this point. the whole update is
+        // checked before anything is written to the next solution.
+        const long numDof = static_cast<long>(model().numTotalDof());
+        bool updateIsFinite = true;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(&&:updateIsFinite)
+#endif
+        for (long dofIdx = 0; dofIdx < numDof; ++dofIdx)
+            updateIsFinite = updateIsFinite && isFinite_(solutionUpdate[static_cast<std::size_t>(dofIdx)]);
+
+        if (!updateIsFinite)
             throw NumericalProblem("Non-finite update!");
 
-        size_t numGridDof = model().numGridDof();
-        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0) {
-                    const auto& constraints = constraintsMap.at(dofIdx);
+        const long numGridDof = static_cast<long>(model().numGridDof());
+        updateConstraintFlags_();
+
+        // update the primary variables of the grid DOFs. exceptions must not escape
+        // the parallel block, so they are bridged out of it.
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long i = 0; i < numGridDof; ++i) {
+            const unsigned dofIdx = static_cast<unsigned>(i);
+            try {
+                if (enableConstraints_() && isConstraintDof_[dofIdx])
                     asImp_().updateConstraintDof_(dofIdx,
                                                   nextSolution[dofIdx],
-                                                  constraints);
-                }
+                                                  constraintsMap.at(dofIdx));
                 else
                     asImp_().updatePrimaryVariables_(dofIdx,
                                                      nextSolution[dofIdx],
@@ -716,20 +883,21 @@ protected:
                                                      solutionUpdate[dofIdx],
                                                      currentResidual[dofIdx]);
             }
-            else
-                asImp_().updatePrimaryVariables_(dofIdx,
-                                                 nextSolution[dofIdx],
-                                                 currentSolution[dofIdx],
-                                                 solutionUpdate[dofIdx],
-                                                 currentResidual[dofIdx]);
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
         }
 
         // update the DOFs of the auxiliary equations
-        size_t numDof = model().numTotalDof();
-        for (size_t dofIdx = numGridDof; dofIdx < numDof; ++dofIdx) {
+        for (std::size_t dofIdx = static_cast<std::size_t>(numGridDof);
+             dofIdx < static_cast<std::size_t>(numDof); ++dofIdx) {
             nextSolution[dofIdx] = currentSolution[dofIdx];
             nextSolution[dofIdx] -= solutionUpdate[dofIdx];
         }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
     }
 
     /*!
@@ -762,7 +930,7 @@ protected:
     void writeConvergence_(const SolutionVector& currentSolution,
                            const GlobalEqVector& solutionUpdate)
     {
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence)) {
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonWriteConvergence)) {
             convergenceWriter_.beginIteration();
             convergenceWriter_.writeFields(currentSolution, solutionUpdate);
             convergenceWriter_.endIteration();
@@ -834,7 +1002,7 @@ protected:
      */
     void end_()
     {
-        if (EWOMS_GET_PARAM(TypeTag, bool, NewtonWriteConvergence))
+        if (EWOMS_GET_CACHED_PARAM(TypeTag, bool, NewtonWriteConvergence))
             convergenceWriter_.endTimeStep();
     }
 
@@ -856,14 +1024,44 @@ protected:
 
     // optimal number of iterations we want to achieve
     int targetIterations_() const
-    { return EWOMS_GET_PARAM(TypeTag, int, NewtonTargetIterations); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, int, NewtonTargetIterations); }
     // maximum number of iterations we do before giving up
     int maxIterations_() const
-    { return EWOMS_GET_PARAM(TypeTag, int, NewtonMaxIterations); }
+    { return EWOMS_GET_CACHED_PARAM(TypeTag, int, NewtonMaxIterations); }
 
     static bool enableConstraints_()
     { return getPropValue<TypeTag, Properties::EnableConstraints>(); }
 
+    // mark the grid DOFs which are subject to constraints. this avoids looking them up
+    // in the constraints map for every DOF. the flags are only rebuilt if the
+    // constraints map or the number of DOFs has changed.
+    void updateConstraintFlags_()
+    {
+        if (!enableConstraints_())
+            return;
+
+        const auto& linearizer = model().linearizer();
+        const std::size_t numGridDof = model().numGridDof();
+        if (isConstraintDof_.size() == numGridDof
+            && constraintFlagsVersion_ == linearizer.constraintsMapVersion())
+            return;
+
+        isConstraintDof_.assign(numGridDof, 0);
+        for (const auto& [dofIdx, constraints] : linearizer.constraintsMap()) {
+            if (dofIdx < numGridDof)
+                isConstraintDof_[dofIdx] = 1;
+        }
+        constraintFlagsVersion_ = linearizer.constraintsMapVersion();
+    }
+
+    static bool isFinite_(const EqVector& update)
+    {
+        for (unsigned eqIdx = 0; eqIdx < update.size(); ++eqIdx)
+            if (!std::isfinite(update[eqIdx]))
+                return false;
+        return true;
+    }
+
     Simulator& simulator_;
 
     Timer prePostProcessTimer_;
@@ -880,6 +1078,19 @@ protected:
     // actual number of iterations done so far
     int numIterations_;
 
+    // state of the "frozen" Jacobian strategy
+    bool frozenJacobian_ = false;
+    Scalar frozenJacobianMaxContraction_;
+    int maxFrozenJacobianIterations_;
+    bool jacobianIsReusable_ = false;
+    int numFrozenJacobianIterations_ = 0;
+    Scalar errorContraction_ = 1.0;
+
+    // for each grid DOF: 1 if it is subject to constraints, 0 otherwise
+    std::vector<unsigned char> isConstraintDof_;
+    // the version of the linearizer's constraints map which isConstraintDof_ refers to
+    unsigned constraintFlagsVersion_ = 0;
+
     // the linear solver
     LinearSolverBackend linearSolver_;
 
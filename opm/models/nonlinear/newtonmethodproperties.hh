@@ -82,6 +82,26 @@ struct NewtonTargetIterations { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct NewtonMaxIterations { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specifies how the Jacobian matrix is obtained in each Newton iteration.
+ *
+ * "full" linearizes the system in every iteration, "frozen" only evaluates the
+ * residual and keeps the Jacobian matrix of a previous iteration as long as the
+ * Newton method converges fast enough.
+ */
+template<class TypeTag, class MyTypeTag>
+struct NewtonJacobianStrategy { using type = UndefinedProperty; };
+
+//! The maximum ratio between the errors of two consecutive Newton iterations for
+//! which the Jacobian matrix is reused by the "frozen" strategy
+template<class TypeTag, class MyTypeTag>
+struct NewtonFrozenJacobianMaxContraction { using type = UndefinedProperty; };
+
+//! The maximum number of consecutive Newton iterations which reuse the same Jacobian
+//! matrix
+template<class TypeTag, class MyTypeTag>
+struct NewtonMaxFrozenJacobianIterations { using type = UndefinedProperty; };
+
 } // end namespace  Opm::Properties
 
 #endif
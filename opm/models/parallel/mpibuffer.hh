@@ -96,7 +96,8 @@ public:
     }
 
     /*!
-     * \brief Wait until the buffer was send to the peer completely.
+     * \brief Wait until the pending asynchronous send or receive operation has
+     *        completed.
      */
     void wait()
     {
@@ -122,18 +123,36 @@ public:
 #endif // HAVE_MPI
     }
 
+    /*!
+     * \brief Start receiving the buffer asyncronously from a peer rank
+     *
+     * The contents of the buffer must not be accessed before wait() was called.
+     */
+    void asyncReceive([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        MPI_Irecv(data_,
+                  static_cast<int>(mpiDataSize_),
+                  mpiDataType_,
+                  static_cast<int>(peerRank),
+                  0, // tag
+                  MPI_COMM_WORLD,
+                  &mpiRequest_);
+#endif // HAVE_MPI
+    }
+
 #if HAVE_MPI
     /*!
      * \brief Returns the current MPI_Request object.
      *
-     * This object is only well defined after the send() method.
+     * This object is only well defined after the send() and asyncReceive() methods.
      */
     MPI_Request& request()
     { return mpiRequest_; }
     /*!
      * \brief Returns the current MPI_Request object.
      *
-     * This object is only well defined after the send() method.
+     * This object is only well defined after the send() and asyncReceive() methods.
      */
     const MPI_Request& request() const
     { return mpiRequest_; }
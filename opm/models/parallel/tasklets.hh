@@ -27,13 +27,25 @@
 #ifndef EWOMS_TASKLETS_HH
 #define EWOMS_TASKLETS_HH
 
-#include <stdexcept>
+#include <atomic>
 #include <cassert>
-#include <thread>
-#include <queue>
-#include <mutex>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
 #include <condition_variable>
+#include <mutex>
+#endif
 
 namespace Opm {
 
@@ -59,7 +71,7 @@ public:
     { return referenceCount_; }
 
 private:
-    int referenceCount_;
+    std::atomic<int> referenceCount_;
 };
 
 /*!
@@ -102,65 +114,231 @@ template <class Dummy>
 thread_local int TaskletRunnerHelper_<Dummy>::workerThreadIndex_ = -1;
 
 /*!
- * \brief Handles where a given tasklet is run.
+ * \brief A bounded lock-free queue which can be used by an arbitrary number of
+ *        producer and consumer threads.
  *
- * Depending on the number of worker threads, a tasklet can either be run in a separate
- * worker thread or by the main thread.
+ * This is the well-known array based algorithm by D. Vyukov: each cell carries a
+ * sequence number which tells producers and consumers whether the cell can currently
+ * be written to or read from.
  */
-class TaskletRunner
+template <class T>
+class BoundedMpmcQueue
 {
-    /// \brief Implements a barrier. This class can only be used in the asynchronous case.
-    class BarrierTasklet : public TaskletInterface
+    struct alignas(64) Cell
     {
-    public:
-        BarrierTasklet(unsigned numWorkers)
-            : TaskletInterface(/*refCount=*/numWorkers)
-        {
-            numWorkers_ = numWorkers;
-            numWaiting_ = 0;
-        }
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
 
-        void run()
-        { wait(); }
+public:
+    /*!
+     * \brief Create a queue which can hold up to capacity objects.
+     *
+     * The capacity must be a power of two.
+     */
+    explicit BoundedMpmcQueue(std::size_t capacity)
+        : cells_(new Cell[capacity])
+        , mask_(capacity - 1)
+        , enqueuePos_(0)
+        , dequeuePos_(0)
+    {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+            throw std::invalid_argument("The capacity of a BoundedMpmcQueue must be a power of two");
+
+        for (std::size_t i = 0; i < capacity; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
 
-        void wait()
-        {
-            std::unique_lock<std::mutex> lock(barrierMutex_);
+    BoundedMpmcQueue(const BoundedMpmcQueue&) = delete;
 
-            numWaiting_ += 1;
-            if (numWaiting_ >= numWorkers_ + 1) {
-                lock.unlock();
-                barrierCondition_.notify_all();
+    /*!
+     * \brief Append an object to the queue. Returns false if the queue is full.
+     */
+    bool push(const T& data)
+    {
+        Cell* cell;
+        std::size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
             }
-            else {
-                const auto& areAllWaiting =
-                    [this]() -> bool
-                    { return this->numWaiting_ >= this->numWorkers_ + 1; };
+            else if (diff < 0)
+                return false; // full
+            else
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
 
-                barrierCondition_.wait(lock, /*predicate=*/areAllWaiting);
+        cell->data = data;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+     * \brief Remove the oldest object from the queue. Returns false if the queue is empty.
+     */
+    bool pop(T& data)
+    {
+        Cell* cell;
+        std::size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
             }
+            else if (diff < 0)
+                return false; // empty
+            else
+                pos = dequeuePos_.load(std::memory_order_relaxed);
         }
 
-    private:
-        unsigned numWorkers_;
-        unsigned numWaiting_;
+        data = cell->data;
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
 
-        std::condition_variable barrierCondition_;
-        std::mutex barrierMutex_;
-    };
+private:
+    std::unique_ptr<Cell[]> cells_;
+    const std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> enqueuePos_;
+    alignas(64) std::atomic<std::size_t> dequeuePos_;
+};
+
+/*!
+ * \brief Recycles the memory of the tasklets created by TaskletRunner::dispatchFunction().
+ *
+ * All blocks have the same size which is large enough for a function runner tasklet
+ * and the control block of its shared pointer. Larger requests are forwarded to the
+ * global operator new. Since the allocators keep the pool alive, tasklets may outlive
+ * the runner which created them.
+ */
+class TaskletMemoryPool
+{
+public:
+    //! the size of the recycled memory blocks in bytes
+    static constexpr std::size_t blockSize = 128;
+
+    //! the maximum number of unused blocks which are kept
+    static constexpr std::size_t capacity = 1024;
+
+    TaskletMemoryPool()
+        : freeBlocks_(capacity)
+    {}
+
+    TaskletMemoryPool(const TaskletMemoryPool&) = delete;
+
+    ~TaskletMemoryPool()
+    {
+        void* block;
+        while (freeBlocks_.pop(block))
+            ::operator delete(block);
+    }
+
+    void* allocate(std::size_t size)
+    {
+        if (size > blockSize)
+            return ::operator new(size);
+
+        void* block;
+        if (freeBlocks_.pop(block))
+            return block;
+        return ::operator new(blockSize);
+    }
 
-    /// \brief TerminateThreadTasklet class
-    /// Empty tasklet marking thread termination.
-    class TerminateThreadTasklet : public TaskletInterface
+    void deallocate(void* block, std::size_t size)
     {
-    public:
-        void run()
-        { }
+        if (size > blockSize || !freeBlocks_.push(block))
+            ::operator delete(block);
+    }
+
+private:
+    BoundedMpmcQueue<void*> freeBlocks_;
+};
+
+/*!
+ * \brief A standard conforming allocator which takes its memory from a
+ *        TaskletMemoryPool.
+ */
+template <class T>
+class TaskletAllocator
+{
+public:
+    using value_type = T;
+
+    explicit TaskletAllocator(std::shared_ptr<TaskletMemoryPool> pool)
+        : pool_(std::move(pool))
+    {}
+
+    template <class U>
+    TaskletAllocator(const TaskletAllocator<U>& other)
+        : pool_(other.pool())
+    {}
+
+    T* allocate(std::size_t n)
+    {
+        if constexpr (alignof(T) > alignof(std::max_align_t))
+            return std::allocator<T>().allocate(n);
+        else
+            return static_cast<T*>(pool_->allocate(n*sizeof(T)));
+    }
 
-        bool isEndMarker() const
-        { return true; }
+    void deallocate(T* ptr, std::size_t n)
+    {
+        if constexpr (alignof(T) > alignof(std::max_align_t))
+            std::allocator<T>().deallocate(ptr, n);
+        else
+            pool_->deallocate(ptr, n*sizeof(T));
+    }
+
+    const std::shared_ptr<TaskletMemoryPool>& pool() const
+    { return pool_; }
+
+    template <class U>
+    bool operator==(const TaskletAllocator<U>& other) const
+    { return pool_ == other.pool(); }
+
+    template <class U>
+    bool operator!=(const TaskletAllocator<U>& other) const
+    { return pool_ != other.pool(); }
+
+private:
+    std::shared_ptr<TaskletMemoryPool> pool_;
+};
+
+/*!
+ * \brief Handles where a given tasklet is run.
+ *
+ * Depending on the number of worker threads, a tasklet can either be run in a separate
+ * worker thread or by the main thread.
+ *
+ * Each worker thread has its own bounded lock-free queue. Tasklets are distributed to
+ * these queues in a round-robin fashion and idle workers steal work from the queues of
+ * the other workers. The queue entries are taken from a pre-allocated pool, so
+ * dispatching a tasklet neither allocates memory nor takes a lock. Idle workers and
+ * barriers sleep on futexes (on Linux, elsewhere on a condition variable) which are only
+ * woken if there is something to be done.
+ */
+class TaskletRunner
+{
+    // the number of entries of each worker's queue
+    static constexpr std::size_t queueCapacity = 1024;
+
+    // a dispatched tasklet. the tasklet is kept alive until all of its invocations
+    // have been run, then the node is returned to the pool.
+    struct Node
+    {
+        std::shared_ptr<TaskletInterface> tasklet;
+        std::atomic<int> numPendingRuns{0};
     };
 
+    using Queue = BoundedMpmcQueue<Node*>;
+
 public:
     // prohibit copying of tasklet runners
     TaskletRunner(const TaskletRunner&) = delete;
@@ -172,7 +350,28 @@ public:
      * thread (synchronous mode).
      */
     TaskletRunner(unsigned numWorkers)
+        : numPending_(0)
+        , workEpoch_(0)
+        , numSleeping_(0)
+        , nextQueue_(0)
+        , stop_(false)
+        , taskletPool_(std::make_shared<TaskletMemoryPool>())
     {
+        if (numWorkers > 0) {
+            std::size_t numNodes = numWorkers*queueCapacity;
+            std::size_t poolCapacity = 2;
+            while (poolCapacity < numNodes)
+                poolCapacity *= 2;
+
+            nodes_.reset(new Node[numNodes]);
+            freeNodes_.reset(new Queue(poolCapacity));
+            for (std::size_t i = 0; i < numNodes; ++i)
+                freeNodes_->push(&nodes_[i]);
+
+            for (unsigned i = 0; i < numWorkers; ++i)
+                queues_.emplace_back(new Queue(queueCapacity));
+        }
+
         threads_.resize(numWorkers);
         for (unsigned i = 0; i < numWorkers; ++i)
             // create a worker thread
@@ -189,8 +388,10 @@ public:
     ~TaskletRunner()
     {
         if (threads_.size() > 0) {
-            // dispatch a tasklet which will terminate the worker thread
-            dispatch(std::make_shared<TerminateThreadTasklet>());
+            // wait until all tasklets are done and then tell the workers to terminate
+            barrier();
+            stop_.store(true, std::memory_order_seq_cst);
+            notifyWorkers_(INT_MAX);
 
             // wait until all worker threads have terminated
             for (auto& thread : threads_)
@@ -237,29 +438,49 @@ public:
                     std::cerr << "ERROR: Uncaught exception (general type) when running tasklet. Trying to continue.\n";
                 }
             }
+            return;
         }
-        else {
-            // lock mutex for the tasklet queue to make sure that nobody messes with the
-            // task queue
-            taskletQueueMutex_.lock();
 
-            // add the tasklet to the queue
-            taskletQueue_.push(tasklet);
-
-            taskletQueueMutex_.unlock();
+        int numRuns = tasklet->referenceCount();
+        if (numRuns <= 0)
+            return;
 
-            workAvailableCondition_.notify_all();
+        // get a node from the pool. if all nodes are in use, help the workers until
+        // one becomes available.
+        Node* node;
+        while (!freeNodes_->pop(node))
+            helpOrYield_();
+
+        node->tasklet = std::move(tasklet);
+        node->numPendingRuns.store(numRuns, std::memory_order_relaxed);
+        numPending_.fetch_add(numRuns, std::memory_order_seq_cst);
+
+        // each invocation of the tasklet gets its own queue entry, so multiple workers
+        // can run the same tasklet concurrently.
+        for (int i = 0; i < numRuns; ++i) {
+            std::size_t queueIdx = nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+            while (!queues_[queueIdx]->push(node)) {
+                // the queue is full: make sure that the workers are awake to drain it
+                notifyWorkers_(INT_MAX);
+                helpOrYield_();
+            }
         }
+
+        notifyWorkers_(numRuns);
     }
 
     /*!
      * \brief Convenience method to construct a new function runner tasklet and dispatch it immediately.
+     *
+     * The memory of the tasklet is recycled once it has been run and all references
+     * to it are gone.
      */
     template <class Fn>
     std::shared_ptr<FunctionRunnerTasklet<Fn> > dispatchFunction(Fn &fn, int numInvocations=1)
     {
         using Tasklet = FunctionRunnerTasklet<Fn>;
-        auto tasklet = std::make_shared<Tasklet>(numInvocations, fn);
+        auto tasklet = std::allocate_shared<Tasklet>(TaskletAllocator<Tasklet>(taskletPool_),
+                                                     numInvocations, fn);
         this->dispatch(tasklet);
         return tasklet;
     }
@@ -269,16 +490,20 @@ public:
      */
     void barrier()
     {
-        unsigned numWorkers = threads_.size();
-        if (numWorkers == 0)
+        if (threads_.empty())
             // nothing needs to be done to implement a barrier in synchronous mode
             return;
 
-        // dispatch a barrier tasklet and wait until it has been run by the worker thread
-        auto barrierTasklet = std::make_shared<BarrierTasklet>(numWorkers);
-        dispatch(barrierTasklet);
+        if (workerThreadIndex() >= 0)
+            throw std::logic_error("TaskletRunner: barrier() must not be called by a worker thread");
 
-        barrierTasklet->wait();
+        // wait until the number of outstanding tasklet invocations drops to zero
+        while (true) {
+            int numPending = numPending_.load(std::memory_order_acquire);
+            if (numPending == 0)
+                return;
+            futexWait_(numPending_, numPending);
+        }
     }
 
 protected:
@@ -291,57 +516,146 @@ protected:
         taskletRunner->run_();
     }
 
-    //! do the work until the queue received an end tasklet
+    //! do the work until the runner is stopped
     void run_()
     {
+        unsigned workerIdx = static_cast<unsigned>(TaskletRunnerHelper_<void>::workerThreadIndex_);
         while (true) {
-            // wait until tasklets have been pushed to the queue. first we need to lock
-            // mutex for access to taskletQueue_
-            std::unique_lock<std::mutex> lock(taskletQueueMutex_);
-
-            const auto& workIsAvailable =
-                [this]() -> bool
-                { return !taskletQueue_.empty(); };
-
-            if (!workIsAvailable())
-                workAvailableCondition_.wait(lock, /*predicate=*/workIsAvailable);
-
-            // remove tasklet from queue
-            std::shared_ptr<TaskletInterface> tasklet = taskletQueue_.front();
-
-            // if tasklet is an end marker, terminate the thread and DO NOT remove the
-            // tasklet.
-            if (tasklet->isEndMarker()) {
-                if(taskletQueue_.size() > 1)
-                    throw std::logic_error("TaskletRunner: Not all queued tasklets were executed");
-                taskletQueueMutex_.unlock();
-                return;
+            Node* node;
+            if (tryPop_(workerIdx, node)) {
+                runNode_(node);
+                continue;
             }
 
-            tasklet->dereference();
-            if (tasklet->referenceCount() == 0)
-                // remove tasklets from the queue as soon as their reference count
-                // reaches zero, i.e. the tasklet has been run often enough.
-                taskletQueue_.pop();
-            lock.unlock();
-
-            // execute tasklet
-            try {
-                tasklet->run();
-            }
-            catch (const std::exception& e) {
-                std::cerr << "ERROR: Uncaught std::exception when running tasklet: " << e.what() << ". Trying to continue.\n";
-            }
-            catch (...) {
-                std::cerr << "ERROR: Uncaught exception when running tasklet. Trying to continue.\n";
+            // no work available. remember the current epoch and check the queues again
+            // before going to sleep. if something is dispatched in between, the epoch
+            // changes and the futex does not block.
+            int epoch = workEpoch_.load(std::memory_order_seq_cst);
+            if (tryPop_(workerIdx, node)) {
+                runNode_(node);
+                continue;
             }
+
+            if (stop_.load(std::memory_order_seq_cst))
+                return;
+
+            numSleeping_.fetch_add(1, std::memory_order_seq_cst);
+            futexWait_(workEpoch_, epoch);
+            numSleeping_.fetch_sub(1, std::memory_order_seq_cst);
+        }
+    }
+
+    // get work from the worker's own queue or steal it from the other ones
+    bool tryPop_(unsigned workerIdx, Node*& node)
+    {
+        std::size_t numQueues = queues_.size();
+        for (std::size_t i = 0; i < numQueues; ++i) {
+            if (queues_[(workerIdx + i) % numQueues]->pop(node))
+                return true;
+        }
+        return false;
+    }
+
+    void runNode_(Node* node)
+    {
+        node->tasklet->dereference();
+
+        // execute tasklet
+        try {
+            node->tasklet->run();
+        }
+        catch (const std::exception& e) {
+            std::cerr << "ERROR: Uncaught std::exception when running tasklet: " << e.what() << ". Trying to continue.\n";
+        }
+        catch (...) {
+            std::cerr << "ERROR: Uncaught exception when running tasklet. Trying to continue.\n";
+        }
+
+        // return the node to the pool after the last invocation of the tasklet
+        if (node->numPendingRuns.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            node->tasklet.reset();
+            freeNodes_->push(node);
         }
+
+        if (numPending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            futexWake_(numPending_, INT_MAX);
+    }
+
+    // wake up to numWorkers sleeping worker threads
+    void notifyWorkers_(int numWorkers)
+    {
+        workEpoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (numSleeping_.load(std::memory_order_seq_cst) > 0)
+            futexWake_(workEpoch_, numWorkers);
+    }
+
+    // called by dispatching threads if the queues or the node pool are exhausted. worker
+    // threads help to process the queued tasklets to avoid dead locks, all other
+    // threads simply wait for the workers to catch up.
+    void helpOrYield_()
+    {
+        int workerIdx = workerThreadIndex();
+        Node* node;
+        if (workerIdx >= 0 && tryPop_(static_cast<unsigned>(workerIdx), node))
+            runNode_(node);
+        else
+            std::this_thread::yield();
+    }
+
+    // block until word does not contain the expected value anymore. (spurious wake ups
+    // are possible.)
+    void futexWait_(std::atomic<int>& word, int expected)
+    {
+#if defined(__linux__)
+        static_assert(sizeof(std::atomic<int>) == sizeof(int),
+                      "std::atomic<int> must be usable as a futex");
+        syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE,
+                expected, nullptr, nullptr, 0);
+#else
+        // the value is checked with the mutex held and futexWake_() acquires the mutex
+        // after the value has been modified, so no wake up can get lost.
+        std::unique_lock<std::mutex> lock(waitMutex_);
+        waitCondition_.wait(lock, [&word, expected]
+                            { return word.load(std::memory_order_acquire) != expected; });
+#endif
+    }
+
+    // wake up threads which are waiting for word to change. this must be called after
+    // word has been modified.
+    void futexWake_([[maybe_unused]] std::atomic<int>& word,
+                    [[maybe_unused]] int numThreads)
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE,
+                numThreads, nullptr, nullptr, 0);
+#else
+        // the workers and the barrier share the condition variable, so all waiting
+        // threads need to be woken up
+        { std::lock_guard<std::mutex> lock(waitMutex_); }
+        waitCondition_.notify_all();
+#endif
     }
 
     std::vector<std::unique_ptr<std::thread> > threads_;
-    std::queue<std::shared_ptr<TaskletInterface> > taskletQueue_;
-    std::mutex taskletQueueMutex_;
-    std::condition_variable workAvailableCondition_;
+    std::vector<std::unique_ptr<Queue> > queues_;
+    std::unique_ptr<Node[]> nodes_;
+    std::unique_ptr<Queue> freeNodes_;
+
+    // the number of tasklet invocations which have not yet been completed
+    alignas(64) std::atomic<int> numPending_;
+    // incremented whenever new work becomes available
+    alignas(64) std::atomic<int> workEpoch_;
+    std::atomic<int> numSleeping_;
+    std::atomic<std::size_t> nextQueue_;
+    std::atomic<bool> stop_;
+
+    // the memory of the tasklets created by dispatchFunction()
+    std::shared_ptr<TaskletMemoryPool> taskletPool_;
+
+#if !defined(__linux__)
+    std::mutex waitMutex_;
+    std::condition_variable waitCondition_;
+#endif
 };
 
 } // end namespace Opm
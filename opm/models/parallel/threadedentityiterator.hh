@@ -27,15 +27,132 @@
 #ifndef EWOMS_THREADED_ENTITY_ITERATOR_HH
 #define EWOMS_THREADED_ENTITY_ITERATOR_HH
 
-#include <thread>
-#include <mutex>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace Opm {
 
+/*!
+ * \brief Splits the entities of a GridView into the contiguous chunks which are worked
+ *        on by a ThreadedEntityIterator.
+ *
+ * Finding the beginning of each chunk requires a sequential pass over the grid
+ * view. Objects which repeatedly iterate over the same grid view can keep an object of
+ * this class and pass it to the ThreadedEntityIterator, so that this pass is only done
+ * if the grid or the number of threads has changed.
+ *
+ * ATTENTION: update() must be called in a sequential context!
+ */
+template <class GridView, int codim>
+class ThreadedEntityIteratorChunks
+{
+    using EntityIterator = typename GridView::template Codim<codim>::Iterator;
+
+public:
+    // the number of chunks per thread. more chunks make stealing more fine grained,
+    // less chunks reduce the overhead of switching between them.
+    static constexpr unsigned chunksPerThread = 16;
+
+    /*!
+     * \brief Recompute the chunks if the grid or the number of threads has changed.
+     *
+     * \param gridView The grid view which is iterated over
+     * \param gridSequenceNumber The sequence number of the current grid
+     */
+    void update(const GridView& gridView, int gridSequenceNumber)
+    {
+        unsigned numThreads = maxThreads();
+        if (gridSequenceNumber_ == gridSequenceNumber && numThreads_ == numThreads)
+            return;
+
+        compute_(gridView, numThreads);
+        gridSequenceNumber_ = gridSequenceNumber;
+    }
+
+    /*!
+     * \brief Unconditionally compute the chunks for a grid view.
+     */
+    void compute(const GridView& gridView)
+    {
+        compute_(gridView, maxThreads());
+        gridSequenceNumber_ = -1;
+    }
+
+    /*!
+     * \brief The iterators to the first entity of each chunk.
+     *
+     * The last entry is the end iterator of the grid view.
+     */
+    const std::vector<EntityIterator>& chunkBegin() const
+    { return chunkBegin_; }
+
+    /*!
+     * \brief The number of threads for which the chunks were computed.
+     */
+    unsigned numThreads() const
+    { return numThreads_; }
+
+    /*!
+     * \brief The number of threads which are used by the next parallel region.
+     */
+    static unsigned maxThreads()
+    {
+#ifdef _OPENMP
+        return static_cast<unsigned>(omp_get_max_threads());
+#else
+        return 1;
+#endif
+    }
+
+private:
+    void compute_(const GridView& gridView, unsigned numThreads)
+    {
+        numThreads_ = numThreads;
+
+        // determine the start of each chunk. the last entry marks the end of the
+        // grid view.
+        std::size_t numEntities = static_cast<std::size_t>(gridView.size(codim));
+        std::size_t numChunks =
+            std::max<std::size_t>(1, std::min<std::size_t>(numEntities,
+                                                           numThreads_*chunksPerThread));
+        std::size_t chunkSize = (numEntities + numChunks - 1)/numChunks;
+
+        chunkBegin_.clear();
+        chunkBegin_.reserve(numChunks + 1);
+        std::size_t entityIdx = 0;
+        auto it = gridView.template begin<codim>();
+        const auto endIt = gridView.template end<codim>();
+        for (; it != endIt; ++it, ++entityIdx) {
+            if (entityIdx % std::max<std::size_t>(chunkSize, 1) == 0)
+                chunkBegin_.push_back(it);
+        }
+        chunkBegin_.push_back(endIt);
+    }
+
+    std::vector<EntityIterator> chunkBegin_;
+    unsigned numThreads_ = 0;
+    int gridSequenceNumber_ = -1;
+};
+
 /*!
  * \brief Provides an STL-iterator like interface to iterate over the enties of a
  *        GridView in OpenMP threaded applications
  *
+ * The entities of the grid view are split into contiguous chunks, either when the object
+ * is constructed or beforehand by a ThreadedEntityIteratorChunks object. Each thread
+ * initially owns an equally sized range of these chunks and
+ * works through it without any synchronization. Threads which run out of work steal
+ * chunks from the end of the ranges of the other threads, so load imbalances are
+ * evened out without the need for a global lock.
+ *
  * ATTENTION: This class must be instantiated in a sequential context!
  */
 template <class GridView, int codim>
@@ -43,58 +160,190 @@ class ThreadedEntityIterator
 {
     using Entity = typename GridView::template Codim<codim>::Entity;
     using EntityIterator = typename GridView::template Codim<codim>::Iterator;
+    using Chunks = ThreadedEntityIteratorChunks<GridView, codim>;
+
+    // the state of a thread. the range of chunks owned by the thread is packed into a
+    // single atomic 64 bit integer so that the owner and thieves can modify it
+    // consistently using compare-and-swap operations.
+    struct alignas(64) ThreadState
+    {
+        ThreadState(std::uint64_t range, const EntityIterator& endIt)
+            : chunkRange(range)
+            , curIt(endIt)
+            , chunkEndIt(endIt)
+        { }
+
+        std::atomic<std::uint64_t> chunkRange;
+        EntityIterator curIt;
+        EntityIterator chunkEndIt;
+    };
+
 public:
     ThreadedEntityIterator(const GridView& gridView)
         : gridView_(gridView)
-        , sequentialIt_(gridView_.template begin<codim>())
-        , sequentialEnd_(gridView.template end<codim>())
-    { }
+        , end_(gridView_.template end<codim>())
+        , finished_(false)
+    {
+        ownChunks_.compute(gridView_);
+        init_(ownChunks_);
+    }
 
-    ThreadedEntityIterator(const ThreadedEntityIterator& other) = default;
+    /*!
+     * \brief Iterate over a grid view using chunks which have been computed beforehand.
+     *
+     * The chunks must be up to date for the grid view and the current number of
+     * threads.
+     */
+    ThreadedEntityIterator(const GridView& gridView, const Chunks& chunks)
+        : gridView_(gridView)
+        , end_(gridView_.template end<codim>())
+        , finished_(false)
+    {
+        assert(chunks.numThreads() == Chunks::maxThreads());
+        assert(!chunks.chunkBegin().empty());
+        init_(chunks);
+    }
+
+    // the per-thread state is not copyable
+    ThreadedEntityIterator(const ThreadedEntityIterator& other) = delete;
 
     // begin iterating over the grid in parallel
     EntityIterator beginParallel()
     {
-        mutex_.lock();
-        auto tmp = sequentialIt_;
-        if (sequentialIt_ != sequentialEnd_)
-            ++sequentialIt_; // make the next thread look at the next element
-        mutex_.unlock();
+        auto& state = *threadStates_[threadId_()];
+        state.curIt = end_;
+        state.chunkEndIt = end_;
+        if (!nextChunk_(state))
+            return end_;
 
-        return tmp;
+        return state.curIt;
     }
 
     // returns true if the last element was reached
     bool isFinished(const EntityIterator& it) const
-    { return it == sequentialEnd_; }
+    { return it == end_; }
 
     // make sure that the loop over the grid is finished
     void setFinished()
-    {
-        mutex_.lock();
-        sequentialIt_ = sequentialEnd_;
-        mutex_.unlock();
-    }
+    { finished_.store(true, std::memory_order_relaxed); }
 
     // prefix increment: goes to the next element which is not yet worked on by any
     // thread
     EntityIterator increment()
     {
-        mutex_.lock();
-        auto tmp = sequentialIt_;
-        if (sequentialIt_ != sequentialEnd_)
-            ++sequentialIt_;
-        mutex_.unlock();
+        auto& state = *threadStates_[threadId_()];
+        if (finished_.load(std::memory_order_relaxed))
+            return end_;
+
+        if (state.curIt != state.chunkEndIt)
+            ++state.curIt;
+
+        if (state.curIt == state.chunkEndIt && !nextChunk_(state))
+            return end_;
 
-        return tmp;
+        return state.curIt;
     }
 
 private:
-    GridView gridView_;
-    EntityIterator sequentialIt_;
-    EntityIterator sequentialEnd_;
+    void init_(const Chunks& chunks)
+    {
+        numThreads_ = chunks.numThreads();
+        chunkBegin_ = &chunks.chunkBegin();
+        const std::size_t numChunks = chunkBegin_->size() - 1;
+
+        // distribute the chunks evenly amongst the threads
+        threadStates_.reserve(numThreads_);
+        for (unsigned threadId = 0; threadId < numThreads_; ++threadId) {
+            std::uint32_t beginChunk = static_cast<std::uint32_t>((threadId*numChunks)/numThreads_);
+            std::uint32_t endChunk = static_cast<std::uint32_t>(((threadId + 1)*numChunks)/numThreads_);
+            threadStates_.push_back(std::make_unique<ThreadState>(packRange_(beginChunk, endChunk), end_));
+        }
+    }
+
+    static std::uint64_t packRange_(std::uint32_t beginChunk, std::uint32_t endChunk)
+    { return (static_cast<std::uint64_t>(beginChunk) << 32) | endChunk; }
+
+    static std::uint32_t rangeBegin_(std::uint64_t range)
+    { return static_cast<std::uint32_t>(range >> 32); }
 
-    std::mutex mutex_;
+    static std::uint32_t rangeEnd_(std::uint64_t range)
+    { return static_cast<std::uint32_t>(range & 0xffffffff); }
+
+    unsigned threadId_() const
+    {
+#ifdef _OPENMP
+        unsigned threadId = static_cast<unsigned>(omp_get_thread_num());
+        assert(threadId < numThreads_);
+        return threadId;
+#else
+        return 0;
+#endif
+    }
+
+    // take the first chunk of the thread's own range
+    static bool popFront_(ThreadState& state, std::uint32_t& chunkIdx)
+    {
+        std::uint64_t range = state.chunkRange.load(std::memory_order_acquire);
+        while (rangeBegin_(range) < rangeEnd_(range)) {
+            std::uint64_t newRange = packRange_(rangeBegin_(range) + 1, rangeEnd_(range));
+            if (state.chunkRange.compare_exchange_weak(range, newRange,
+                                                       std::memory_order_acq_rel,
+                                                       std::memory_order_acquire))
+            {
+                chunkIdx = rangeBegin_(range);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // take the last chunk of another thread's range
+    static bool popBack_(ThreadState& victim, std::uint32_t& chunkIdx)
+    {
+        std::uint64_t range = victim.chunkRange.load(std::memory_order_acquire);
+        while (rangeBegin_(range) < rangeEnd_(range)) {
+            std::uint64_t newRange = packRange_(rangeBegin_(range), rangeEnd_(range) - 1);
+            if (victim.chunkRange.compare_exchange_weak(range, newRange,
+                                                        std::memory_order_acq_rel,
+                                                        std::memory_order_acquire))
+            {
+                chunkIdx = rangeEnd_(range) - 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // make the thread work on the next chunk. returns false if all chunks are done.
+    bool nextChunk_(ThreadState& state)
+    {
+        std::uint32_t chunkIdx;
+        bool found = popFront_(state, chunkIdx);
+
+        // if the thread's own chunks are all processed, try to steal one of another
+        // thread.
+        unsigned myId = threadId_();
+        for (unsigned i = 1; !found && i < numThreads_; ++i)
+            found = popBack_(*threadStates_[(myId + i) % numThreads_], chunkIdx);
+
+        if (!found || finished_.load(std::memory_order_relaxed)) {
+            state.curIt = end_;
+            state.chunkEndIt = end_;
+            return false;
+        }
+
+        state.curIt = (*chunkBegin_)[chunkIdx];
+        state.chunkEndIt = (*chunkBegin_)[chunkIdx + 1];
+        return true;
+    }
+
+    GridView gridView_;
+    EntityIterator end_;
+    Chunks ownChunks_;
+    const std::vector<EntityIterator>* chunkBegin_;
+    std::vector<std::unique_ptr<ThreadState>> threadStates_;
+    unsigned numThreads_;
+    std::atomic<bool> finished_;
 };
 } // namespace Opm
 
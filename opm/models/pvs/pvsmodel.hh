@@ -48,13 +48,18 @@
 #include <opm/models/io/vtkcompositionmodule.hh>
 #include <opm/models/io/vtkenergymodule.hh>
 #include <opm/models/io/vtkdiffusionmodule.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
 
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/fluidmatrixinteractions/MaterialTraits.hpp>
 
+#include <algorithm>
+#include <exception>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace Opm {
@@ -487,6 +492,13 @@ public:
      * \internal
      * \brief Do the primary variable switching after a Newton iteration.
      *
+     * The degrees of freedom are processed concurrently. If the intensive quantities
+     * of a degree of freedom are cached, they are used to decide about the switch,
+     * else they are computed and, if the intensive quantities are updated
+     * incrementally, stored in the cache for the next linearization. The primary
+     * variables of a degree of freedom are only modified if its phase presence
+     * changes, so only the intensive quantities of these need to be recomputed.
+     *
      * This is an internal method that needs to be public because it
      * gets called by the Newton method after an update.
      */
@@ -496,43 +508,124 @@ public:
 
         int succeeded;
         try {
-            std::vector<bool> visited(this->numGridDof(), false);
-            ElementContext elemCtx(this->simulator_);
-
-            for (const auto& elem : elements(this->gridView_, Dune::Partitions::interior)) {
-                elemCtx.updateStencil(elem);
-
-                size_t numLocalDof = elemCtx.stencil(/*timeIdx=*/0).numPrimaryDof();
-                for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
-                    unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
-
-                    if (visited[globalIdx])
-                        continue;
-                    visited[globalIdx] = true;
-
-                    // compute the intensive quantities of the current degree of freedom
-                    auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
-                    elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
-                    const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
-
-                    // evaluate primary variable switch
-                    short oldPhasePresence = priVars.phasePresence();
-
-                    // set the primary variables and the new phase state
-                    // from the current fluid state
-                    priVars.assignNaive(intQuants.fluidState());
-
-                    if (oldPhasePresence != priVars.phasePresence()) {
-                        if (verbosity_ > 1)
-                            printSwitchedPhases_(elemCtx,
-                                                 dofIdx,
-                                                 intQuants.fluidState(),
-                                                 oldPhasePresence,
-                                                 priVars);
-                        ++numSwitched_;
+            // the vector is kept between the Newton iterations to avoid re-allocating
+            // it. the flags are set atomically because the degrees of freedom of the
+            // elements processed by different threads may be shared.
+            switchVisited_.resize(this->numGridDof());
+            std::fill(switchVisited_.begin(), switchVisited_.end(), 0);
+
+            const bool keepIntensiveQuantities = this->enableIncrementalIntensiveQuantities();
+
+            std::mutex exceptionLock;
+            std::exception_ptr exceptionPtr = nullptr;
+
+            ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(this->gridView_, this->elementChunks());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                ElementContext elemCtx(this->simulator_);
+                unsigned threadNumSwitched = 0;
+
+                ElementIterator elemIt = threadedElemIt.beginParallel();
+                try {
+                    for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                        const Element& elem = *elemIt;
+                        if (elem.partitionType() != Dune::InteriorEntity)
+                            continue;
+
+                        // the full stencil is only required if some intensive quantities
+                        // must be computed or if a switch is printed
+                        elemCtx.updatePrimaryStencil(elem);
+                        bool haveFullStencil = false;
+
+                        size_t numLocalDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                        for (unsigned dofIdx = 0; dofIdx < numLocalDof; ++dofIdx) {
+                            unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+
+                            unsigned char wasVisited;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+                            {
+                                wasVisited = switchVisited_[globalIdx];
+                                switchVisited_[globalIdx] = 1;
+                            }
+                            if (wasVisited)
+                                continue;
+
+                            auto& priVars = this->solution(/*timeIdx=*/0)[globalIdx];
+
+                            // get the intensive quantities of the current degree of freedom
+                            const IntensiveQuantities* intQuants =
+                                this->cachedIntensiveQuantities(globalIdx, /*timeIdx=*/0);
+                            const bool computed = !intQuants;
+                            if (computed) {
+                                if (!haveFullStencil) {
+                                    elemCtx.updateStencil(elem);
+                                    haveFullStencil = true;
+                                }
+                                elemCtx.updateIntensiveQuantities(priVars, dofIdx, /*timeIdx=*/0);
+                                intQuants = &std::as_const(elemCtx).intensiveQuantities(dofIdx, /*timeIdx=*/0);
+                            }
+
+                            // evaluate primary variable switch
+                            short oldPhasePresence = priVars.phasePresence();
+                            PrimaryVariables newPriVars(priVars);
+                            newPriVars.assignNaive(intQuants->fluidState());
+
+                            if (oldPhasePresence == newPriVars.phasePresence()) {
+                                // the intensive quantities stay valid for the next
+                                // linearization
+                                if (computed && keepIntensiveQuantities)
+                                    this->updateCachedIntensiveQuantities(*intQuants,
+                                                                          globalIdx,
+                                                                          /*timeIdx=*/0);
+                                continue;
+                            }
+
+                            if (verbosity_ > 1) {
+                                if (!haveFullStencil) {
+                                    elemCtx.updateStencil(elem);
+                                    haveFullStencil = true;
+                                }
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+                                printSwitchedPhases_(elemCtx,
+                                                     dofIdx,
+                                                     intQuants->fluidState(),
+                                                     oldPhasePresence,
+                                                     newPriVars);
+                            }
+
+                            // set the primary variables and the new phase state from the
+                            // current fluid state. the intensive quantities need to be
+                            // recomputed.
+                            priVars = newPriVars;
+                            this->setIntensiveQuantitiesCacheEntryValidity(globalIdx,
+                                                                           /*timeIdx=*/0,
+                                                                           /*valid=*/false);
+                            ++threadNumSwitched;
+                        }
                     }
                 }
-            }
+                // exceptions must not escape the parallel block, see
+                // FvBaseLinearizer::linearize_()
+                catch (...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                    threadedElemIt.setFinished();
+                }
+
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+                numSwitched_ += threadNumSwitched;
+            } // parallel block
+
+            if (exceptionPtr)
+                std::rethrow_exception(exceptionPtr);
 
             succeeded = 1;
         }
@@ -615,6 +708,10 @@ public:
     // iteration
     unsigned numSwitched_;
 
+    // the degrees of freedom which were already considered by the primary variable
+    // switching of the current Newton iteration
+    std::vector<unsigned char> switchVisited_;
+
     // verbosity of the model
     int verbosity_;
 };
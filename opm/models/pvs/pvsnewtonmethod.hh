@@ -73,6 +73,19 @@ protected:
     friend NewtonMethod<TypeTag>;
     friend ParentType;
 
+    /*!
+     * \copydoc FvBaseNewtonMethod::primaryVariablesChanged_
+     */
+    bool primaryVariablesChanged_(const PrimaryVariables& nextValue,
+                                  const PrimaryVariables& currentValue,
+                                  Scalar tolerance) const
+    {
+        if (nextValue.phasePresence() != currentValue.phasePresence())
+            return true;
+
+        return ParentType::primaryVariablesChanged_(nextValue, currentValue, tolerance);
+    }
+
     /*!
      * \copydoc FvBaseNewtonMethod::updatePrimaryVariables_
      */
@@ -140,6 +140,10 @@ struct InitialTimeStepSize { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct RestartTime { using type = UndefinedProperty; };
 
+//! Specify whether restart files are written and read in the binary format
+template<class TypeTag, class MyTypeTag>
+struct EnableBinaryRestart { using type = UndefinedProperty; };
+
 //! The name of the file with a number of forced time step lengths
 template<class TypeTag, class MyTypeTag>
 struct PredeterminedTimeStepsFile { using type = UndefinedProperty; };
@@ -270,6 +274,10 @@ struct RestartTime<TypeTag, TTag::NumericModel>
     static constexpr type value = -1e35;
 };
 
+//! By default, restart files are text based
+template<class TypeTag>
+struct EnableBinaryRestart<TypeTag, TTag::NumericModel> { static constexpr bool value = false; };
+
 //! By default, do not force any time steps
 template<class TypeTag>
 struct PredeterminedTimeStepsFile<TypeTag, TTag::NumericModel> { static constexpr auto value = ""; };
@@ -41,7 +41,10 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parametertree.hh>
 
+#include <atomic>
+#include <functional>
 #include <map>
+#include <mutex>
 #include <set>
 #include <list>
 #include <sstream>
@@ -53,6 +56,12 @@
 #include <unistd.h>
 #include <sys/ioctl.h>
 
+// record the string based parameter lookups which happen after the parameter
+// registration has been closed. (see Opm::Parameters::printLookupStatistics())
+#ifndef EWOMS_AUDIT_PARAM_LOOKUPS
+#define EWOMS_AUDIT_PARAM_LOOKUPS 0
+#endif
+
 /*!
  * \ingroup Parameter
  *
@@ -115,6 +124,27 @@
     (::Opm::Parameters::get<TypeTag, ParamType>(#ParamName, #ParamName, \
                                                 getPropValue<TypeTag, Properties::ParamName>()))
 
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Retrieve a runtime parameter without any string based lookups.
+ *
+ * This is a drop-in replacement for \c EWOMS_GET_PARAM which is intended
+ * to be used in code paths that are executed frequently: The value of
+ * the parameter is resolved once after the parameter registration has
+ * been closed and is afterwards served from a cache that is keyed by
+ * the type tag and the property at compile time.
+ *
+ * Example:
+ *
+ * \code
+ * // Retrieves the maximum number of Newton iterations from the cache
+ * int maxIter = EWOMS_GET_CACHED_PARAM(TypeTag, int, NewtonMaxIterations);
+ * \endcode
+ */
+#define EWOMS_GET_CACHED_PARAM(TypeTag, ParamType, ParamName)           \
+    (::Opm::Parameters::CachedParam<TypeTag, ParamType, ::Opm::Properties::ParamName>::get(#ParamName))
+
 //!\cond SKIP_THIS
 #define EWOMS_GET_PARAM_(TypeTag, ParamType, ParamName)                 \
     (::Opm::Parameters::get<TypeTag, ParamType>(#ParamName, #ParamName, \
@@ -253,12 +283,26 @@ struct ParameterMetaData<TypeTag, TTag::ParameterSystem>
     static bool& registrationOpen()
     { return storage_().registrationOpen; }
 
+    // incremented whenever the values of the parameters may have changed, i.e.,
+    // cached parameter values are only valid if they were resolved during the
+    // current generation
+    static std::atomic<unsigned>& generation()
+    { return storage_().generation; }
+
+    static std::map<std::string, std::size_t>& lookupCounts()
+    { return storage_().lookupCounts; }
+
+    static std::mutex& lookupCountsMutex()
+    { return storage_().lookupCountsMutex; }
+
     static void clear()
     {
         storage_().tree.reset(new Dune::ParameterTree());
         storage_().finalizers.clear();
         storage_().registrationOpen = true;
         storage_().registry.clear();
+        storage_().lookupCounts.clear();
+        ++ storage_().generation;
     }
 
 private:
@@ -271,12 +315,16 @@ private:
         {
             tree.reset(new Dune::ParameterTree());
             registrationOpen = true;
+            generation = 1;
         }
 
         std::unique_ptr<Dune::ParameterTree> tree;
         std::map<std::string, ::Opm::Parameters::ParamInfo> registry;
         std::list<std::unique_ptr<::Opm::Parameters::ParamRegFinalizerBase_> > finalizers;
         bool registrationOpen;
+        std::atomic<unsigned> generation;
+        std::map<std::string, std::size_t> lookupCounts;
+        std::mutex lookupCountsMutex;
     };
     static Storage_& storage_() {
         static Storage_ obj;
@@ -1091,11 +1139,107 @@ private:
         // NewtonWriteConvergence = true
         std::string canonicalName(paramName);
 
+#if EWOMS_AUDIT_PARAM_LOOKUPS
+        // keep track of all string based lookups which happen after the
+        // registration has been closed. these are the ones which may end up in
+        // performance critical code paths.
+        if (!ParamsMeta::registrationOpen()) {
+            std::lock_guard<std::mutex> lock(ParamsMeta::lookupCountsMutex());
+            ++ ParamsMeta::lookupCounts()[canonicalName];
+        }
+#endif
+
         // retrieve actual parameter from the parameter tree
         return ParamsMeta::tree().template get<ParamType>(canonicalName, defaultValue);
     }
 };
 
+/*!
+ * \brief Compile-time keyed cache for the value of a single run-time parameter.
+ *
+ * Use the \c EWOMS_GET_CACHED_PARAM macro instead of accessing this class
+ * directly.
+ */
+template <class TypeTag, class ParamType, template<class, class> class Property>
+class CachedParam
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+public:
+    static const ParamType& get(const char* paramName)
+    {
+        auto& e = entry_();
+        if (e.generation.load(std::memory_order_acquire)
+            != ParamsMeta::generation().load(std::memory_order_relaxed))
+            resolve_(e, paramName);
+
+        return e.value;
+    }
+
+private:
+    struct Entry_
+    {
+        std::atomic<unsigned> generation{0};
+        ParamType value{};
+        std::mutex mutex;
+    };
+
+    static Entry_& entry_()
+    {
+        static Entry_ obj;
+        return obj;
+    }
+
+    static void resolve_(Entry_& e, const char* paramName)
+    {
+        std::lock_guard<std::mutex> lock(e.mutex);
+        unsigned curGeneration = ParamsMeta::generation().load();
+        if (e.generation.load(std::memory_order_relaxed) == curGeneration)
+            return; // some other thread was faster
+
+        // this throws if the parameter registration is still open, so the
+        // cache is never populated with values which may still change.
+        e.value = Param<TypeTag>::template get<ParamType>(paramName,
+                                                          paramName,
+                                                          getPropValue<TypeTag, Property>());
+        e.generation.store(curGeneration, std::memory_order_release);
+    }
+};
+
+/*!
+ * \ingroup Parameter
+ * \brief Print the number of string based parameter lookups which happened
+ *        after the parameter registration was closed.
+ *
+ * Parameters which show up here with large counts are retrieved in code which
+ * is executed frequently and should thus be accessed via
+ * \c EWOMS_GET_CACHED_PARAM. The lookups are only recorded if the code was
+ * compiled with \c EWOMS_AUDIT_PARAM_LOOKUPS set to a non-zero value.
+ *
+ * \param os The \c std::ostream on which the message should be printed
+ *
+ * \return true if something was printed
+ */
+template <class TypeTag>
+bool printLookupStatistics(std::ostream& os = std::cout)
+{
+    using ParamsMeta = GetProp<TypeTag, Properties::ParameterMetaData>;
+
+    std::lock_guard<std::mutex> lock(ParamsMeta::lookupCountsMutex());
+    if (ParamsMeta::lookupCounts().empty())
+        return false;
+
+    std::multimap<std::size_t, std::string, std::greater<std::size_t> > sortedCounts;
+    for (const auto& [paramName, count] : ParamsMeta::lookupCounts())
+        sortedCounts.emplace(count, paramName);
+
+    os << "# [string based parameter lookups after registration]\n";
+    for (const auto& [count, paramName] : sortedCounts)
+        os << paramName << "=" << count << "\n";
+    os << std::flush;
+    return true;
+}
+
 template <class TypeTag, class ParamType, class PropTag>
 const ParamType get(const char *propTagName, const char *paramName, bool errorIfNotRegistered)
 {
@@ -1213,6 +1357,9 @@ void endParamRegistration()
 
     ParamsMeta::registrationOpen() = false;
 
+    // all values cached before this point are potentially stale
+    ++ ParamsMeta::generation();
+
     // loop over all parameters and retrieve their values to make sure
     // that there is no syntax error
     auto pIt = ParamsMeta::registrationFinalizers().begin();
@@ -1220,6 +1367,9 @@ void endParamRegistration()
     for (; pIt != pEndIt; ++pIt)
         (*pIt)->retrieve();
     ParamsMeta::registrationFinalizers().clear();
+
+    // the syntax checks above do not count as lookups
+    ParamsMeta::lookupCounts().clear();
 }
 //! \endcond
 
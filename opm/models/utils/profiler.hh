@@ -0,0 +1,419 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Hierarchical scoped timers and counters which are written to a per-process
+ *        CSV profile.
+ *
+ * The instrumentation is only compiled in if \c EWOMS_ENABLE_PROFILING is set to a
+ * non-zero value. Otherwise, all \c EWOMS_PROFILE_* macros expand to nothing.
+ *
+ * Example:
+ *
+ * \code
+ * {
+ *     EWOMS_PROFILE_SCOPE("linearize");
+ *     ...
+ *     EWOMS_PROFILE_COUNT("elements", numElements);
+ * }
+ * ...
+ * // write everything which was recorded since the last flush
+ * EWOMS_PROFILE_FLUSH(timeStepIdx, iterationIdx);
+ * \endcode
+ */
+#ifndef EWOMS_PROFILER_HH
+#define EWOMS_PROFILER_HH
+
+#ifndef EWOMS_ENABLE_PROFILING
+#define EWOMS_ENABLE_PROFILING 0
+#endif
+
+#if EWOMS_ENABLE_PROFILING
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define EWOMS_PROFILE_CONCAT_(a, b) a ## b
+#define EWOMS_PROFILE_CONCAT(a, b) EWOMS_PROFILE_CONCAT_(a, b)
+
+/*!
+ * \brief Measure the time spent until the end of the current scope.
+ *
+ * The name must be a string literal. Nested scopes form a hierarchy.
+ */
+#define EWOMS_PROFILE_SCOPE(name)                                       \
+    ::Opm::ProfileScope EWOMS_PROFILE_CONCAT(ewomsProfileScope, __LINE__)(name)
+
+/*!
+ * \brief Add a number to a counter of the innermost active scope.
+ */
+#define EWOMS_PROFILE_COUNT(name, n)            \
+    ::Opm::Profiler::count(name, n)
+
+/*!
+ * \brief Specify the file to which the profile of the current process is written.
+ */
+#define EWOMS_PROFILE_OPEN(fileName, rank)      \
+    ::Opm::Profiler::open(fileName, rank)
+
+/*!
+ * \brief Write everything recorded since the last flush to the profile.
+ *
+ * This must only be called by the main thread and outside of parallel regions.
+ */
+#define EWOMS_PROFILE_FLUSH(timeStepIdx, iterationIdx)          \
+    ::Opm::Profiler::flush(timeStepIdx, iterationIdx)
+
+namespace Opm {
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Collects the data of the scoped timers and counters.
+ *
+ * Each thread records into its own tree, so no synchronization is required while
+ * measuring. If the profile is flushed, the trees of all threads are merged and written
+ * as CSV rows of the form
+ *
+ * <tt>rank,time_step,iteration,path,kind,count,seconds</tt>
+ *
+ * where <tt>kind</tt> is either <tt>timer</tt> or <tt>counter</tt>. For timers,
+ * <tt>count</tt> is the number of times the scope was entered. The trees of threads
+ * other than the main one are attached to the node of the main thread which has a
+ * child of the same name, i.e., scopes entered by the threads of a parallel region show
+ * up below the scope which contains the region.
+ */
+class Profiler
+{
+public:
+    struct Node
+    {
+        Node(const char* nodeName, Node* parentNode)
+            : name(nodeName)
+            , parent(parentNode)
+        {}
+
+        Node* child(const char* childName)
+        {
+            // string literals usually are unique, so compare the pointers first
+            for (auto& c : children)
+                if (c->name == childName)
+                    return c.get();
+            for (auto& c : children)
+                if (std::strcmp(c->name, childName) == 0)
+                    return c.get();
+
+            children.emplace_back(new Node(childName, this));
+            return children.back().get();
+        }
+
+        void addCount(const char* counterName, std::uint64_t n)
+        {
+            for (auto& c : counters) {
+                if (c.first == counterName || std::strcmp(c.first, counterName) == 0) {
+                    c.second += n;
+                    return;
+                }
+            }
+            counters.emplace_back(counterName, n);
+        }
+
+        const char* name;
+        Node* parent;
+        std::vector<std::unique_ptr<Node> > children;
+        std::vector<std::pair<const char*, std::uint64_t> > counters;
+        std::uint64_t calls = 0;
+        std::uint64_t nanoseconds = 0;
+    };
+
+    struct ThreadData
+    {
+        ThreadData()
+            : root("", nullptr)
+            , current(&root)
+        {}
+
+        Node root;
+        Node* current;
+    };
+
+    /*!
+     * \brief Returns the data recorded by the calling thread.
+     */
+    static ThreadData& threadData()
+    {
+        thread_local ThreadData* data = registerThread_();
+        return *data;
+    }
+
+    static void count(const char* name, std::uint64_t n)
+    { threadData().current->addCount(name, n); }
+
+    /*!
+     * \brief Adds time which was measured elsewhere to a child of the current scope.
+     */
+    static void addTime(const char* name, std::uint64_t calls, std::uint64_t nanoseconds)
+    {
+        if (calls == 0)
+            return;
+
+        Node* node = threadData().current->child(name);
+        node->calls += calls;
+        node->nanoseconds += nanoseconds;
+    }
+
+    static void open(const std::string& fileName, int rank)
+    {
+        auto& s = storage_();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.rank = rank;
+        s.outStream.open(fileName);
+        if (!s.outStream)
+            throw std::runtime_error("Could not open profile file '"+fileName+"'");
+        s.outStream << "rank,time_step,iteration,path,kind,count,seconds\n";
+    }
+
+    static void flush(int timeStepIdx, int iterationIdx)
+    {
+        ThreadData& mainData = threadData();
+
+        auto& s = storage_();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        Node merged("", nullptr);
+        merge_(merged, mainData.root);
+        for (auto& data : s.threads) {
+            if (data.get() == &mainData)
+                continue;
+
+            for (const auto& [name, n] : data->root.counters)
+                merged.addCount(name, n);
+            for (const auto& c : data->root.children) {
+                Node* anchor = findParentOf_(merged, c->name);
+                merge_(*(anchor ? anchor : &merged)->child(c->name), *c);
+            }
+        }
+
+        if (s.outStream.is_open()) {
+            for (const auto& c : merged.children)
+                write_(s, *c, c->name, timeStepIdx, iterationIdx);
+            for (const auto& [name, n] : merged.counters)
+                writeCounter_(s, name, n, timeStepIdx, iterationIdx);
+            s.outStream << std::flush;
+        }
+
+        for (auto& data : s.threads)
+            reset_(data->root);
+    }
+
+private:
+    struct Storage_
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadData> > threads;
+        std::ofstream outStream;
+        int rank = 0;
+    };
+
+    static Storage_& storage_()
+    {
+        static Storage_ obj;
+        return obj;
+    }
+
+    static ThreadData* registerThread_()
+    {
+        auto& s = storage_();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.threads.emplace_back(new ThreadData);
+        return s.threads.back().get();
+    }
+
+    static void merge_(Node& dest, const Node& src)
+    {
+        dest.calls += src.calls;
+        dest.nanoseconds += src.nanoseconds;
+        for (const auto& [name, n] : src.counters)
+            dest.addCount(name, n);
+        for (const auto& c : src.children)
+            merge_(*dest.child(c->name), *c);
+    }
+
+    // breadth first search for the node which has a child of a given name
+    static Node* findParentOf_(Node& root, const char* childName)
+    {
+        std::vector<Node*> queue{&root};
+        for (std::size_t i = 0; i < queue.size(); ++i) {
+            for (auto& c : queue[i]->children) {
+                if (std::strcmp(c->name, childName) == 0)
+                    return queue[i];
+                queue.push_back(c.get());
+            }
+        }
+        return nullptr;
+    }
+
+    static void reset_(Node& node)
+    {
+        node.calls = 0;
+        node.nanoseconds = 0;
+        for (auto& c : node.counters)
+            c.second = 0;
+        for (auto& c : node.children)
+            reset_(*c);
+    }
+
+    static void write_(Storage_& s, const Node& node, const std::string& path,
+                       int timeStepIdx, int iterationIdx)
+    {
+        if (node.calls > 0)
+            s.outStream << s.rank << "," << timeStepIdx << "," << iterationIdx << ","
+                        << path << ",timer," << node.calls << ","
+                        << static_cast<double>(node.nanoseconds)*1e-9 << "\n";
+
+        for (const auto& [name, n] : node.counters)
+            writeCounter_(s, path + "/" + name, n, timeStepIdx, iterationIdx);
+
+        for (const auto& c : node.children)
+            write_(s, *c, path + "/" + c->name, timeStepIdx, iterationIdx);
+    }
+
+    static void writeCounter_(Storage_& s, const std::string& path, std::uint64_t n,
+                              int timeStepIdx, int iterationIdx)
+    {
+        if (n == 0)
+            return;
+
+        s.outStream << s.rank << "," << timeStepIdx << "," << iterationIdx << ","
+                    << path << ",counter," << n << ",\n";
+    }
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Adds the time until it is destroyed to a node of the profile.
+ *
+ * Use the \c EWOMS_PROFILE_SCOPE macro instead of this class directly.
+ */
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+        : data_(Profiler::threadData())
+    {
+        node_ = data_.current->child(name);
+        data_.current = node_;
+        startTime_ = std::chrono::steady_clock::now();
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    ~ProfileScope()
+    {
+        const auto dt = std::chrono::steady_clock::now() - startTime_;
+        node_->nanoseconds +=
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+        ++ node_->calls;
+        data_.current = node_->parent;
+    }
+
+private:
+    Profiler::ThreadData& data_;
+    Profiler::Node* node_;
+    std::chrono::steady_clock::time_point startTime_;
+};
+
+/*!
+ * \ingroup Common
+ *
+ * \brief Accumulates the time spent in a section of code which is entered too often to
+ *        be profiled by a scope, e.g., once for each element.
+ *
+ * The time is only added to the profile by flush(). This is supposed to happen once
+ * per loop, from the thread which records the scope that contains the loop. If the
+ * loop is run by several threads, the times of their accumulators add up and may thus
+ * exceed the time of the enclosing scope.
+ */
+class ProfileAccumulator
+{
+public:
+    void start()
+    { startTime_ = std::chrono::steady_clock::now(); }
+
+    void stop()
+    {
+        const auto dt = std::chrono::steady_clock::now() - startTime_;
+        nanoseconds_ +=
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(dt).count());
+        ++ calls_;
+    }
+
+    void flush(const char* name)
+    {
+        Profiler::addTime(name, calls_, nanoseconds_);
+        calls_ = 0;
+        nanoseconds_ = 0;
+    }
+
+private:
+    std::chrono::steady_clock::time_point startTime_;
+    std::uint64_t calls_ = 0;
+    std::uint64_t nanoseconds_ = 0;
+};
+
+} // namespace Opm
+
+#else // !EWOMS_ENABLE_PROFILING
+
+#define EWOMS_PROFILE_SCOPE(name) do {} while (false)
+#define EWOMS_PROFILE_COUNT(name, n) do { static_cast<void>(n); } while (false)
+#define EWOMS_PROFILE_OPEN(fileName, rank) do {} while (false)
+#define EWOMS_PROFILE_FLUSH(timeStepIdx, iterationIdx) do {} while (false)
+
+namespace Opm {
+
+// accumulators do nothing if profiling is disabled
+class ProfileAccumulator
+{
+public:
+    void start() {}
+    void stop() {}
+    void flush(const char*) {}
+};
+
+} // namespace Opm
+
+#endif // EWOMS_ENABLE_PROFILING
+
+#endif
@@ -28,8 +28,10 @@
 #ifndef EWOMS_SIMULATOR_HH
 #define EWOMS_SIMULATOR_HH
 
+#include <opm/models/io/binaryrestart.hh>
 #include <opm/models/io/restart.hh>
 #include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/profiler.hh>
 
 #include <opm/models/utils/basicproperties.hh>
 #include <opm/models/utils/propertysystem.hh>
@@ -260,6 +262,8 @@ public:
                              "The size of the initial time step [s]");
         EWOMS_REGISTER_PARAM(TypeTag, Scalar, RestartTime,
                              "The simulation time at which a restart should be attempted [s]");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, EnableBinaryRestart,
+                             "Write and read restart files in the binary, checksummed format");
         EWOMS_REGISTER_PARAM(TypeTag, std::string, PredeterminedTimeStepsFile,
                              "A file with a list of predetermined time step sizes (one "
                              "time step per line)");
@@ -648,20 +652,18 @@ public:
         TimerGuard prePostProcessTimerGuard(prePostProcessTimer_);
         TimerGuard writeTimerGuard(writeTimer_);
 
+        EWOMS_PROFILE_OPEN(profileFileName_(), gridView().comm().rank());
+
         setupTimer_.start();
         Scalar restartTime = EWOMS_GET_PARAM(TypeTag, Scalar, RestartTime);
         if (restartTime > -1e30) {
             // try to restart a previous simulation
             time_ = restartTime;
 
-            Restart res;
-            EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(res.deserializeBegin(*this, time_));
-            if (verbose_)
-                std::cout << "Deserialize from file '" << res.fileName() << "'\n" << std::flush;
-            EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(this->deserialize(res));
-            EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->deserialize(res));
-            EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(model_->deserialize(res));
-            EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(res.deserializeEnd());
+            if (EWOMS_GET_PARAM(TypeTag, bool, EnableBinaryRestart))
+                restart_<BinaryRestart>();
+            else
+                restart_<Restart>();
             if (verbose_)
                 std::cout << "Deserialization done."
                           << " Simulator time: " << time() << humanReadableTime(time())
@@ -695,6 +697,11 @@ public:
         bool episodeBegins = episodeIsOver() || (timeStepIdx_ == 0);
         // do the time steps
         while (!finished()) {
+            // everything which happened outside of the Newton iterations of the
+            // previous time step
+            EWOMS_PROFILE_FLUSH(timeStepIdx_ - 1, /*iterationIdx=*/-1);
+            EWOMS_PROFILE_SCOPE("time_step");
+
             prePostProcessTimer_.start();
             if (episodeBegins) {
                 // notify the problem that a new episode has just been
@@ -762,8 +769,10 @@ public:
 
             // write the result to disk
             writeTimer_.start();
-            if (problem_->shouldWriteOutput())
+            if (problem_->shouldWriteOutput()) {
+                EWOMS_PROFILE_SCOPE("write_output");
                 EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->writeOutput());
+            }
             writeTimer_.stop();
 
             // do the next time integration
@@ -809,6 +818,7 @@ public:
             writeTimer_.stop();
         }
         executionTimer_.stop();
+        EWOMS_PROFILE_FLUSH(timeStepIdx_ - 1, /*iterationIdx=*/-1);
 
         EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->finalize());
     }
@@ -901,22 +911,16 @@ public:
      * The file will start with the prefix returned by the name()
      * method, has the current time of the simulation clock in it's
      * name and uses the extension <tt>.ers</tt>. (Ewoms ReStart
-     * file.)  See Opm::Restart for details.
+     * file.)  See Opm::Restart for details. If binary restart files
+     * are enabled, the extension <tt>.erb</tt> is used instead. (See
+     * Opm::BinaryRestart.)
      */
     void serialize()
     {
-        using Restarter = Restart;
-        Restarter res;
-        res.serializeBegin(*this);
-        if (gridView().comm().rank() == 0)
-            std::cout << "Serialize to file '" << res.fileName() << "'"
-                      << ", next time step size: " << timeStepSize()
-                      << "\n" << std::flush;
-
-        this->serialize(res);
-        problem_->serialize(res);
-        model_->serialize(res);
-        res.serializeEnd();
+        if (EWOMS_GET_PARAM(TypeTag, bool, EnableBinaryRestart))
+            serialize_<BinaryRestart>();
+        else
+            serialize_<Restart>();
     }
 
     /*!
@@ -976,6 +980,49 @@ public:
     }
 
 private:
+#if EWOMS_ENABLE_PROFILING
+    std::string profileFileName_() const
+    {
+        std::string dir = problem_->outputDir();
+        if (dir == ".")
+            dir = "";
+        else if (!dir.empty() && dir.back() != '/')
+            dir += "/";
+
+        return dir + problem_->name() + "_profile_rank="
+            + std::to_string(gridView().comm().rank()) + ".csv";
+    }
+#endif
+
+    template <class Restarter>
+    void serialize_()
+    {
+        Restarter res;
+        res.serializeBegin(*this);
+        if (gridView().comm().rank() == 0)
+            std::cout << "Serialize to file '" << res.fileName() << "'"
+                      << ", next time step size: " << timeStepSize()
+                      << "\n" << std::flush;
+
+        this->serialize(res);
+        problem_->serialize(res);
+        model_->serialize(res);
+        res.serializeEnd();
+    }
+
+    template <class Restarter>
+    void restart_()
+    {
+        Restarter res;
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(res.deserializeBegin(*this, time_));
+        if (verbose_)
+            std::cout << "Deserialize from file '" << res.fileName() << "'\n" << std::flush;
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(this->deserialize(res));
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->deserialize(res));
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(model_->deserialize(res));
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(res.deserializeEnd());
+    }
+
     std::unique_ptr<Vanguard> vanguard_;
     std::unique_ptr<Model> model_;
     std::unique_ptr<Problem> problem_;
@@ -393,6 +393,11 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
         if (myRank == 0) {
             std::cout << "Simulation completed" << std::endl;                                 
         }
+
+#if EWOMS_AUDIT_PARAM_LOOKUPS
+        if (myRank == 0)
+            Parameters::printLookupStatistics<TypeTag>();
+#endif
         return 0;
     }
     catch (std::exception& e)
@@ -0,0 +1,229 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::CsrSparsityPattern
+ */
+#ifndef EWOMS_CSR_SPARSITY_PATTERN_HH
+#define EWOMS_CSR_SPARSITY_PATTERN_HH
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ * \brief The sparsity pattern of a matrix in compressed row storage (CSR) format.
+ *
+ * In contrast to a vector of std::set objects, the pattern is assembled without any
+ * allocation per entry:
+ *
+ * - beginCount() and count() determine an upper bound for the size of each row,
+ * - beginFill() computes the row offsets and allocates the storage for the column
+ *   indices,
+ * - add() writes the column indices of the entries,
+ * - finalize() sorts the column indices of each row and removes the duplicates.
+ *
+ * The count() and add() methods may be called concurrently from multiple threads, and
+ * finalize() processes the rows in parallel.
+ */
+class CsrSparsityPattern
+{
+public:
+    using Index = unsigned;
+
+    /*!
+     * \brief Start the counting pass for a given number of rows.
+     */
+    void beginCount(std::size_t numRows)
+    {
+        rowOffsets_.assign(numRows + 1, 0);
+        fillPos_.clear();
+        columnIndices_.clear();
+    }
+
+    /*!
+     * \brief Reserve space for a given number of entries in a row.
+     *
+     * Every later call of add() for the row must be counted, including the ones for
+     * duplicate entries.
+     */
+    void count(std::size_t rowIdx, std::size_t numEntries = 1)
+    {
+        assert(rowIdx + 1 < rowOffsets_.size());
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+        rowOffsets_[rowIdx + 1] += numEntries;
+    }
+
+    /*!
+     * \brief Reserve space for the entries of a sparsity pattern given by a vector of
+     *        sets.
+     *
+     * This allows to incorporate patterns of code which only provides its entries as
+     * a set per row, e.g., auxiliary modules.
+     */
+    template <class Set>
+    void count(const std::vector<Set>& sparsityPattern)
+    {
+        assert(sparsityPattern.size() == numRows());
+        for (std::size_t rowIdx = 0; rowIdx < sparsityPattern.size(); ++rowIdx)
+            rowOffsets_[rowIdx + 1] += sparsityPattern[rowIdx].size();
+    }
+
+    /*!
+     * \brief Finish the counting pass and allocate the storage for the column indices.
+     */
+    void beginFill()
+    {
+        std::partial_sum(rowOffsets_.begin(), rowOffsets_.end(), rowOffsets_.begin());
+        columnIndices_.resize(rowOffsets_.back());
+        fillPos_.assign(rowOffsets_.begin(), rowOffsets_.end() - 1);
+    }
+
+    /*!
+     * \brief Add an entry to the pattern.
+     *
+     * The number of calls for a given row must not exceed the number of entries which
+     * were counted for it.
+     */
+    void add(std::size_t rowIdx, Index colIdx)
+    {
+        std::size_t pos;
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+        pos = fillPos_[rowIdx]++;
+
+        assert(pos < rowOffsets_[rowIdx + 1]);
+        columnIndices_[pos] = colIdx;
+    }
+
+    /*!
+     * \brief Add the entries of a sparsity pattern given by a vector of sets.
+     */
+    template <class Set>
+    void add(const std::vector<Set>& sparsityPattern)
+    {
+        assert(sparsityPattern.size() == numRows());
+        for (std::size_t rowIdx = 0; rowIdx < sparsityPattern.size(); ++rowIdx)
+            for (const auto colIdx : sparsityPattern[rowIdx])
+                add(rowIdx, colIdx);
+    }
+
+    /*!
+     * \brief Sort the column indices of each row, remove the duplicates and compact the
+     *        storage.
+     */
+    void finalize()
+    {
+        const long numRows = static_cast<long>(this->numRows());
+
+        std::vector<std::size_t> rowSizes(numRows);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            const auto rowBegin = columnIndices_.begin() + rowOffsets_[rowIdx];
+            const auto rowEnd = columnIndices_.begin() + fillPos_[rowIdx];
+            std::sort(rowBegin, rowEnd);
+            rowSizes[rowIdx] = std::unique(rowBegin, rowEnd) - rowBegin;
+        }
+
+        // the rows only shrink, so they can be moved to the front in place
+        std::size_t numNonZeros = 0;
+        for (long rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            if (rowOffsets_[rowIdx] != numNonZeros) {
+                const auto rowBegin = columnIndices_.begin() + rowOffsets_[rowIdx];
+                std::copy(rowBegin, rowBegin + rowSizes[rowIdx], columnIndices_.begin() + numNonZeros);
+                rowOffsets_[rowIdx] = numNonZeros;
+            }
+            numNonZeros += rowSizes[rowIdx];
+        }
+        rowOffsets_[numRows] = numNonZeros;
+
+        columnIndices_.resize(numNonZeros);
+        columnIndices_.shrink_to_fit();
+        fillPos_.clear();
+        fillPos_.shrink_to_fit();
+    }
+
+    /*!
+     * \brief Returns the number of rows of the pattern.
+     */
+    std::size_t numRows() const
+    { return rowOffsets_.empty() ? 0 : rowOffsets_.size() - 1; }
+
+    /*!
+     * \brief Returns the number of entries of the finalized pattern.
+     */
+    std::size_t numNonZeros() const
+    { return columnIndices_.size(); }
+
+    /*!
+     * \brief Returns the number of entries of a row of the finalized pattern.
+     */
+    std::size_t rowSize(std::size_t rowIdx) const
+    { return rowOffsets_[rowIdx + 1] - rowOffsets_[rowIdx]; }
+
+    /*!
+     * \brief Returns a pointer to the sorted column indices of a row of the finalized
+     *        pattern.
+     */
+    const Index* rowBegin(std::size_t rowIdx) const
+    { return columnIndices_.data() + rowOffsets_[rowIdx]; }
+
+    /*!
+     * \brief Returns a pointer past the last column index of a row of the finalized
+     *        pattern.
+     */
+    const Index* rowEnd(std::size_t rowIdx) const
+    { return columnIndices_.data() + rowOffsets_[rowIdx + 1]; }
+
+    /*!
+     * \brief Returns the offsets of the rows into the array of column indices.
+     */
+    const std::vector<std::size_t>& rowOffsets() const
+    { return rowOffsets_; }
+
+    /*!
+     * \brief Returns the column indices of all rows.
+     */
+    const std::vector<Index>& columnIndices() const
+    { return columnIndices_; }
+
+private:
+    std::vector<std::size_t> rowOffsets_;
+    std::vector<std::size_t> fillPos_;
+    std::vector<Index> columnIndices_;
+};
+
+}} // namespace Linear, Opm
+
+#endif
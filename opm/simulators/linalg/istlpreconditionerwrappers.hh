@@ -40,6 +40,11 @@
  * - \c SOR: A successive overrelaxation (SOR) preconditioner
  * - \c ILUn: An ILU(n) preconditioner
  * - \c ILU0: A specialized (and optimized) ILU(0) preconditioner
+ *
+ * All wrappers store the preconditioner using the floating point type specified by the
+ * PreconditionerScalar property. If it is less precise than the one of the linear
+ * solver, the matrix is copied and the preconditioner is applied via a
+ * MixedPrecisionPreconditioner.
  */
 #ifndef EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 #define EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
@@ -48,6 +53,7 @@
 #include <opm/models/utils/parametersystem.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 #include <opm/simulators/linalg/ilufirstelement.hh> //definitions needed in next header
+#include <opm/simulators/linalg/mixedprecisionpreconditioner.hh>
 #include <dune/istl/preconditioners.hh>
 
 #include <dune/common/version.hh>
@@ -62,11 +68,14 @@ namespace Linear {
         using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>; \
         using IstlMatrix = typename SparseMatrixAdapter::IstlMatrix;            \
         using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>; \
+        using PreconditionerScalar = GetPropType<TypeTag, Properties::PreconditionerScalar>; \
+        using Factory = MixedPrecisionPreconditionerFactory<IstlMatrix,         \
+                                                            OverlappingVector,  \
+                                                            PreconditionerScalar, \
+                                                            ISTL_PREC_TYPE>;    \
                                                                                 \
     public:                                                                     \
-        using SequentialPreconditioner = ISTL_PREC_TYPE<IstlMatrix,             \
-                                                        OverlappingVector,      \
-                                                        OverlappingVector>;     \
+        using SequentialPreconditioner = typename Factory::SequentialPreconditioner; \
         PreconditionerWrapper##PREC_NAME()                                      \
         {}                                                                      \
                                                                                 \
@@ -83,18 +92,17 @@ namespace Linear {
         {                                                                       \
             int order = EWOMS_GET_PARAM(TypeTag, int, PreconditionerOrder);     \
             Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);   \
-            seqPreCond_ = new SequentialPreconditioner(matrix, order,           \
-                                                       relaxationFactor);       \
+            factory_.prepare(matrix, order, relaxationFactor);                  \
         }                                                                       \
                                                                                 \
         SequentialPreconditioner& get()                                         \
-        { return *seqPreCond_; }                                                \
+        { return factory_.get(); }                                              \
                                                                                 \
         void cleanup()                                                          \
-        { delete seqPreCond_; }                                                 \
+        { factory_.cleanup(); }                                                 \
                                                                                 \
     private:                                                                    \
-        SequentialPreconditioner *seqPreCond_;                                  \
+        Factory factory_;                                                       \
     };
 
 // the same as the EWOMS_WRAP_ISTL_PRECONDITIONER macro, but without
@@ -106,11 +114,14 @@ namespace Linear {
         using Scalar = GetPropType<TypeTag, Properties::Scalar>;                 \
         using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>; \
         using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>; \
+        using PreconditionerScalar = GetPropType<TypeTag, Properties::PreconditionerScalar>; \
+        using Factory = MixedPrecisionPreconditionerFactory<OverlappingMatrix,  \
+                                                            OverlappingVector,  \
+                                                            PreconditionerScalar, \
+                                                            ISTL_PREC_TYPE>;    \
                                                                                 \
     public:                                                                     \
-        using SequentialPreconditioner = ISTL_PREC_TYPE<OverlappingMatrix,      \
-                                                        OverlappingVector,      \
-                                                        OverlappingVector>;     \
+        using SequentialPreconditioner = typename Factory::SequentialPreconditioner; \
         PreconditionerWrapper##PREC_NAME()                                      \
         {}                                                                      \
                                                                                 \
@@ -125,18 +136,17 @@ namespace Linear {
         {                                                                       \
             Scalar relaxationFactor =                                           \
                 EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);     \
-            seqPreCond_ = new SequentialPreconditioner(matrix,                  \
-                                                       relaxationFactor);       \
+            factory_.prepare(matrix, relaxationFactor);                         \
         }                                                                       \
                                                                                 \
         SequentialPreconditioner& get()                                         \
-        { return *seqPreCond_; }                                                \
+        { return factory_.get(); }                                              \
                                                                                 \
         void cleanup()                                                          \
-        { delete seqPreCond_; }                                                 \
+        { factory_.cleanup(); }                                                 \
                                                                                 \
     private:                                                                    \
-        SequentialPreconditioner *seqPreCond_;                                  \
+        Factory factory_;                                                       \
     };
 
 EWOMS_WRAP_ISTL_PRECONDITIONER(Jacobi, Dune::SeqJac)
@@ -153,11 +163,19 @@ class PreconditionerWrapperILU
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
     using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+    using PreconditionerScalar = GetPropType<TypeTag, Properties::PreconditionerScalar>;
 
     static constexpr int order = getPropValue<TypeTag, Properties::PreconditionerOrder>();
 
+    template <class Matrix, class Domain, class Range>
+    using IstlILU = Dune::SeqILU<Matrix, Domain, Range, order>;
+    using Factory = MixedPrecisionPreconditionerFactory<OverlappingMatrix,
+                                                        OverlappingVector,
+                                                        PreconditionerScalar,
+                                                        IstlILU>;
+
 public:
-    using SequentialPreconditioner = Dune::SeqILU<OverlappingMatrix, OverlappingVector, OverlappingVector, order>;
+    using SequentialPreconditioner = typename Factory::SequentialPreconditioner;
 
     PreconditionerWrapperILU()
     {}
@@ -173,17 +191,17 @@ public:
         Scalar relaxationFactor = EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRelaxation);
 
         // create the sequential preconditioner.
-        seqPreCond_ = new SequentialPreconditioner(matrix, relaxationFactor);
+        factory_.prepare(matrix, relaxationFactor);
     }
 
     SequentialPreconditioner& get()
-    { return *seqPreCond_; }
+    { return factory_.get(); }
 
     void cleanup()
-    { delete seqPreCond_; }
+    { factory_.cleanup(); }
 
 private:
-    SequentialPreconditioner *seqPreCond_;
+    Factory factory_;
 };
 
 #undef EWOMS_WRAP_ISTL_PRECONDITIONER
@@ -27,6 +27,8 @@
 #ifndef EWOMS_ISTL_SPARSE_MATRIX_ADAPTER_HH
 #define EWOMS_ISTL_SPARSE_MATRIX_ADAPTER_HH
 
+#include <opm/simulators/linalg/csrsparsitypattern.hh>
+
 #include <dune/istl/bcrsmatrix.hh>
 #include <dune/common/fmatrix.hh>
 #include <dune/common/version.hh>
@@ -100,6 +102,31 @@ public:
         istlMatrix_->endindices();
     }
 
+    /*!
+     * \brief Allocate matrix structure given a sparsity pattern in CSR format.
+     *
+     * Since the column indices of each row are already sorted and unique, they are
+     * copied into the matrix row by row without any further searching.
+     */
+    void reserve(const CsrSparsityPattern& sparsityPattern)
+    {
+        // allocate raw matrix
+        istlMatrix_.reset(new IstlMatrix(rows_, columns_, IstlMatrix::random));
+
+        // make sure sparsityPattern is consistent with number of rows
+        assert(rows_ == sparsityPattern.numRows());
+
+        for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx)
+            istlMatrix_->setrowsize(dofIdx, sparsityPattern.rowSize(dofIdx));
+        istlMatrix_->endrowsizes();
+
+        for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx)
+            istlMatrix_->setIndices(dofIdx,
+                                    sparsityPattern.rowBegin(dofIdx),
+                                    sparsityPattern.rowEnd(dofIdx));
+        istlMatrix_->endindices();
+    }
+
     /*!
      * \brief Return constant reference to matrix implementation.
      */
@@ -46,6 +46,16 @@ struct PreconditionerWrapper { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct LinearSolverScalar { using type = UndefinedProperty; };
 
+/*!
+ * \brief The floating point type used to store the preconditioner.
+ *
+ * Using a less precise type than LinearSolverScalar reduces the memory traffic of
+ * applying the preconditioner while the Krylov solver keeps the precision of the
+ * linear solver.
+ */
+template<class TypeTag, class MyTypeTag>
+struct PreconditionerScalar { using type = UndefinedProperty; };
+
 /*!
  * \brief The size of the algebraic overlap of the linear solver.
  *
@@ -90,6 +100,21 @@ struct PreconditionerOrder { using type = UndefinedProperty; };
 template<class TypeTag, class MyTypeTag>
 struct PreconditionerRelaxation { using type = UndefinedProperty; };
 
+/*!
+ * \brief Specifies whether the preconditioner is kept across linear solves.
+ *
+ * If enabled, the preconditioner is only set up from scratch if the grid changed, if
+ * the previous linear solve failed or if the number of linear iterations degraded
+ * beyond PreconditionerRebuildIterationFactor.
+ */
+template<class TypeTag, class MyTypeTag>
+struct PreconditionerReuse { using type = UndefinedProperty; };
+
+//! The factor by which the number of linear iterations may grow compared to the first
+//! solve after the last setup before a reused preconditioner is rebuilt
+template<class TypeTag, class MyTypeTag>
+struct PreconditionerRebuildIterationFactor { using type = UndefinedProperty; };
+
 //! number of iterations between solver restarts for the GMRES solver
 template<class TypeTag, class MyTypeTag>
 struct GMResRestart { using type = UndefinedProperty; };
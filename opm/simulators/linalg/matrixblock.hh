@@ -26,6 +26,7 @@
 #include <dune/common/dynmatrix.hh>
 #include <dune/common/fmatrix.hh>
 #include <dune/common/typetraits.hh>
+#include <dune/common/version.hh>
 
 #include <dune/istl/superlu.hh>
 #include <dune/istl/umfpack.hh>
@@ -33,7 +34,9 @@
 
 #include <opm/common/Exceptions.hpp>
 
+#include <cmath>
 #include <limits>
+#include <utility>
 
 namespace Opm {
 namespace detail {
@@ -220,8 +223,140 @@ static inline void invertMatrix(Dune::DynamicMatrix<K>& matrix)
      matrix.invert();
 }
 
+/*!
+ * \brief Specifies whether the fixed-size kernels below are used for blocks of a given
+ *        size.
+ *
+ * The kernels keep the rows of the block and the input vector in local arrays with a
+ * compile-time size. This allows the compiler to fully unroll and vectorize them, and
+ * avoids the repeated loads and stores which are necessary if the result may alias the
+ * block. For larger blocks, the generic code of dune-common is used.
+ */
+template <int n, int m>
+constexpr bool useBlockKernels = n == m && n >= 2 && n <= 6;
+
+//! y = A x
+template <class K, int n, int m, class Block, class X, class Y>
+static inline void blockMv(const Block& A, const X& x, Y& y)
+{
+    K xl[m];
+    for (int j = 0; j < m; ++j)
+        xl[j] = x[j];
+
+    for (int i = 0; i < n; ++i) {
+        K sum = 0.0;
+        for (int j = 0; j < m; ++j)
+            sum += A[i][j]*xl[j];
+        y[i] = sum;
+    }
+}
+
+//! y += alpha A x
+template <class K, int n, int m, class Block, class X, class Y>
+static inline void blockUsmv(const Block& A, K alpha, const X& x, Y& y)
+{
+    K xl[m];
+    for (int j = 0; j < m; ++j)
+        xl[j] = alpha*x[j];
+
+    for (int i = 0; i < n; ++i) {
+        K sum = 0.0;
+        for (int j = 0; j < m; ++j)
+            sum += A[i][j]*xl[j];
+        y[i] += sum;
+    }
+}
+
+//! A = A B
+template <class K, int n, int m, class Block, class OtherBlock>
+static inline void blockRightmultiply(Block& A, const OtherBlock& B)
+{
+    K bl[m][m];
+    for (int k = 0; k < m; ++k)
+        for (int j = 0; j < m; ++j)
+            bl[k][j] = B[k][j];
+
+    for (int i = 0; i < n; ++i) {
+        K row[m];
+        for (int k = 0; k < m; ++k)
+            row[k] = A[i][k];
+
+        for (int j = 0; j < m; ++j) {
+            K sum = 0.0;
+            for (int k = 0; k < m; ++k)
+                sum += row[k]*bl[k][j];
+            A[i][j] = sum;
+        }
+    }
+}
+
+//! solve A x = b using a LU decomposition with partial pivoting
+template <class K, int n, class Block, class X, class Y>
+static inline void blockSolve(const Block& A, X& x, const Y& b)
+{
+    K lu[n][n];
+    K xl[n];
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j)
+            lu[i][j] = A[i][j];
+        xl[i] = b[i];
+    }
+
+    for (int k = 0; k < n; ++k) {
+        int pivotIdx = k;
+        for (int i = k + 1; i < n; ++i)
+            if (std::abs(lu[i][k]) > std::abs(lu[pivotIdx][k]))
+                pivotIdx = i;
+
+        if (!(std::abs(lu[pivotIdx][k]) > std::numeric_limits<K>::min()))
+            throw NumericalProblem("Singular matrix");
+
+        if (pivotIdx != k) {
+            for (int j = 0; j < n; ++j)
+                std::swap(lu[k][j], lu[pivotIdx][j]);
+            std::swap(xl[k], xl[pivotIdx]);
+        }
+
+        const K pivotInv = 1.0/lu[k][k];
+        for (int i = k + 1; i < n; ++i) {
+            const K factor = lu[i][k]*pivotInv;
+            for (int j = k + 1; j < n; ++j)
+                lu[i][j] -= factor*lu[k][j];
+            xl[i] -= factor*xl[k];
+        }
+    }
+
+    for (int i = n - 1; i >= 0; --i) {
+        K sum = xl[i];
+        for (int j = i + 1; j < n; ++j)
+            sum -= lu[i][j]*xl[j];
+        xl[i] = sum/lu[i][i];
+    }
+
+    for (int i = 0; i < n; ++i)
+        x[i] = xl[i];
+}
+
 } // namespace detail
 
+/*!
+ * \brief Assign the derivatives of a vector of automatic differentiation objects to a
+ *        matrix block.
+ *
+ * Entry (i, j) of the block becomes the derivative of the i-th evaluation with regard to
+ * the j-th primary variable.
+ */
+template <int n, int m, class Block, class EvalVector>
+static inline void assignDerivatives(Block& block, const EvalVector& evals)
+{
+    for (int i = 0; i < n; ++i) {
+        auto& row = block[i];
+        const auto& eval = evals[i];
+        for (int j = 0; j < m; ++j)
+            row[j] = eval.derivative(j);
+    }
+}
+
 template <class Scalar, int n, int m>
 class MatrixBlock : public Dune::FieldMatrix<Scalar, n, m>
 {
@@ -243,6 +378,74 @@ public:
     void invert()
     { detail::invertMatrix(asBase()); }
 
+    //! y = A x
+    template <class X, class Y>
+    void mv(const X& x, Y& y) const
+    {
+        if constexpr (detail::useBlockKernels<n, m>)
+            detail::blockMv<Scalar, n, m>(*this, x, y);
+        else
+            BaseType::mv(x, y);
+    }
+
+    //! y += A x
+    template <class X, class Y>
+    void umv(const X& x, Y& y) const
+    {
+        if constexpr (detail::useBlockKernels<n, m>)
+            detail::blockUsmv<Scalar, n, m>(*this, Scalar(1.0), x, y);
+        else
+            BaseType::umv(x, y);
+    }
+
+    //! y -= A x
+    template <class X, class Y>
+    void mmv(const X& x, Y& y) const
+    {
+        if constexpr (detail::useBlockKernels<n, m>)
+            detail::blockUsmv<Scalar, n, m>(*this, Scalar(-1.0), x, y);
+        else
+            BaseType::mmv(x, y);
+    }
+
+    //! y += alpha A x
+    template <class X, class Y>
+    void usmv(const typename Dune::FieldTraits<Y>::field_type& alpha, const X& x, Y& y) const
+    {
+        if constexpr (detail::useBlockKernels<n, m>)
+            detail::blockUsmv<Scalar, n, m>(*this, Scalar(alpha), x, y);
+        else
+            BaseType::usmv(alpha, x, y);
+    }
+
+    //! A = A M
+    template <class OtherMatrix>
+    MatrixBlock& rightmultiply(const OtherMatrix& M)
+    {
+        if constexpr (detail::useBlockKernels<n, m>)
+            detail::blockRightmultiply<Scalar, n, m>(*this, M);
+        else
+            BaseType::rightmultiply(M);
+        return *this;
+    }
+
+    //! solve A x = b
+    template <class X, class Y>
+    void solve(X& x, const Y& b, bool doPivoting = true) const
+    {
+        if constexpr (detail::useBlockKernels<n, m>)
+            detail::blockSolve<Scalar, n>(*this, x, b);
+        else {
+#if DUNE_VERSION_NEWER(DUNE_COMMON, 2, 7)
+            BaseType::solve(x, b, doPivoting);
+#else
+            // older versions of dune-common always use partial pivoting
+            static_cast<void>(doPivoting);
+            BaseType::solve(x, b);
+#endif
+        }
+    }
+
     const BaseType& asBase() const
     { return static_cast<const BaseType&>(*this); }
 
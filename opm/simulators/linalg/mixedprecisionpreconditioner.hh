@@ -0,0 +1,263 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::MixedPrecisionPreconditioner
+ */
+#ifndef EWOMS_MIXED_PRECISION_PRECONDITIONER_HH
+#define EWOMS_MIXED_PRECISION_PRECONDITIONER_HH
+
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ * \brief Create a BCRS matrix which exhibits the same sparsity pattern as a given one.
+ *
+ * The floating point type of the new matrix may differ from the one of the original
+ * matrix. Its entries are not initialized.
+ */
+template <class DstMatrix, class SrcMatrix>
+std::unique_ptr<DstMatrix> copyMatrixPattern(const SrcMatrix& src)
+{
+    auto dst = std::make_unique<DstMatrix>(src.N(), src.M(), DstMatrix::random);
+    for (std::size_t rowIdx = 0; rowIdx < src.N(); ++rowIdx)
+        dst->setrowsize(rowIdx, src[rowIdx].size());
+    dst->endrowsizes();
+
+    for (std::size_t rowIdx = 0; rowIdx < src.N(); ++rowIdx) {
+        const auto& row = src[rowIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+            dst->addindex(rowIdx, colIt.index());
+    }
+    dst->endindices();
+
+    return dst;
+}
+
+/*!
+ * \ingroup Linear
+ * \brief Returns true if two BCRS matrices exhibit the same sparsity pattern.
+ *
+ * The floating point types of the matrices may differ. All column indices are
+ * compared, so this also detects patterns which were changed without altering the
+ * number of non-zero entries.
+ */
+template <class MatrixA, class MatrixB>
+bool haveSameMatrixPattern(const MatrixA& a, const MatrixB& b)
+{
+    if (a.N() != b.N() || a.M() != b.M() || a.nonzeroes() != b.nonzeroes())
+        return false;
+
+    for (std::size_t rowIdx = 0; rowIdx < a.N(); ++rowIdx) {
+        const auto& rowA = a[rowIdx];
+        const auto& rowB = b[rowIdx];
+        if (rowA.size() != rowB.size())
+            return false;
+
+        auto colItB = rowB.begin();
+        for (auto colItA = rowA.begin(); colItA != rowA.end(); ++colItA, ++colItB)
+            if (colItA.index() != colItB.index())
+                return false;
+    }
+
+    return true;
+}
+
+/*!
+ * \ingroup Linear
+ * \brief Copy the entries of a BCRS matrix to a matrix with the same sparsity pattern
+ *        but a possibly different floating point type.
+ */
+template <class DstMatrix, class SrcMatrix>
+void copyMatrixValues(DstMatrix& dst, const SrcMatrix& src)
+{
+    assert(dst.N() == src.N() && dst.nonzeroes() == src.nonzeroes());
+    for (std::size_t rowIdx = 0; rowIdx < src.N(); ++rowIdx) {
+        auto dstColIt = dst[rowIdx].begin();
+        const auto& srcRow = src[rowIdx];
+        for (auto srcColIt = srcRow.begin(); srcColIt != srcRow.end(); ++srcColIt, ++dstColIt) {
+            const auto& srcBlock = *srcColIt;
+            auto& dstBlock = *dstColIt;
+            for (std::size_t i = 0; i < srcBlock.N(); ++i)
+                for (std::size_t j = 0; j < srcBlock.M(); ++j)
+                    dstBlock[i][j] = srcBlock[i][j];
+        }
+    }
+}
+
+/*!
+ * \ingroup Linear
+ * \brief Applies a preconditioner which uses a lower floating point precision than the
+ *        linear solver.
+ *
+ * Applying a preconditioner is usually limited by the memory bandwidth, so storing it
+ * in single precision roughly halves its costs. The vectors passed by the linear
+ * solver are converted to the precision of the inner preconditioner and the result is
+ * converted back, i.e., the linear solver itself still uses the full precision.
+ *
+ * The inner preconditioner is not owned by this object. Modifications of the vectors
+ * by the pre() and post() methods of the inner preconditioner are not propagated back
+ * to the linear solver. (The sequential preconditioners and the AMG of dune-istl do
+ * not modify the zero initial solution.)
+ */
+template <class InnerPreconditioner, class Domain, class Range = Domain>
+class MixedPrecisionPreconditioner : public Dune::Preconditioner<Domain, Range>
+{
+    using InnerDomain = typename InnerPreconditioner::domain_type;
+    using InnerRange = typename InnerPreconditioner::range_type;
+
+public:
+    using domain_type = Domain;
+    using range_type = Range;
+    using field_type = typename Domain::field_type;
+
+    MixedPrecisionPreconditioner(InnerPreconditioner& innerPreconditioner, std::size_t numRows)
+        : innerPreconditioner_(innerPreconditioner)
+        , innerX_(numRows)
+        , innerB_(numRows)
+    {}
+
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+    void pre(Domain& x, Range& b) override
+    {
+        convert_(innerX_, x);
+        convert_(innerB_, b);
+        innerPreconditioner_.pre(innerX_, innerB_);
+    }
+
+    void apply(Domain& v, const Range& d) override
+    {
+        convert_(innerX_, v);
+        convert_(innerB_, d);
+        innerPreconditioner_.apply(innerX_, innerB_);
+        convert_(v, innerX_);
+    }
+
+    void post(Domain& x) override
+    {
+        convert_(innerX_, x);
+        innerPreconditioner_.post(innerX_);
+    }
+
+private:
+    template <class DstVector, class SrcVector>
+    static void convert_(DstVector& dst, const SrcVector& src)
+    {
+        for (std::size_t i = 0; i < src.size(); ++i)
+            for (std::size_t k = 0; k < src[i].size(); ++k)
+                dst[i][k] = src[i][k];
+    }
+
+    InnerPreconditioner& innerPreconditioner_;
+    InnerDomain innerX_;
+    InnerRange innerB_;
+};
+
+/*!
+ * \ingroup Linear
+ * \brief Creates a sequential dune-istl preconditioner which stores its data using a
+ *        given floating point type.
+ *
+ * If this type differs from the one of the matrix, a copy of the matrix using the
+ * preconditioner's precision is kept and the resulting preconditioner is applied via a
+ * MixedPrecisionPreconditioner. Otherwise, the preconditioner directly operates on the
+ * matrix.
+ */
+template <class Matrix,
+          class Vector,
+          class PreconditionerScalar,
+          template <class, class, class> class IstlPreconditioner>
+class MixedPrecisionPreconditionerFactory
+{
+    static constexpr int numEq = Vector::block_type::dimension;
+
+public:
+    static constexpr bool mixedPrecision =
+        !std::is_same<PreconditionerScalar, typename Vector::field_type>::value;
+
+    using LowMatrix = Dune::BCRSMatrix<MatrixBlock<PreconditionerScalar, numEq, numEq>>;
+    using LowVector = Dune::BlockVector<Dune::FieldVector<PreconditionerScalar, numEq>>;
+    using LowPreconditioner = IstlPreconditioner<LowMatrix, LowVector, LowVector>;
+    using SequentialPreconditioner =
+        std::conditional_t<mixedPrecision,
+                           MixedPrecisionPreconditioner<LowPreconditioner, Vector>,
+                           IstlPreconditioner<Matrix, Vector, Vector>>;
+
+    /*!
+     * \brief Create the preconditioner for a matrix.
+     *
+     * \param matrix The matrix for which the preconditioner is created
+     * \param args The additional arguments for the constructor of the dune-istl
+     *             preconditioner
+     */
+    template <class... Args>
+    void prepare(Matrix& matrix, Args&&... args)
+    {
+        if constexpr (mixedPrecision) {
+            // the pattern of the copy is kept as long as the one of the matrix does not
+            // change
+            if (!lowMatrix_ || !haveSameMatrixPattern(*lowMatrix_, matrix))
+                lowMatrix_ = copyMatrixPattern<LowMatrix>(matrix);
+            copyMatrixValues(*lowMatrix_, matrix);
+            lowPreCond_ = std::make_unique<LowPreconditioner>(*lowMatrix_, std::forward<Args>(args)...);
+            seqPreCond_ = std::make_unique<SequentialPreconditioner>(*lowPreCond_, matrix.N());
+        }
+        else
+            seqPreCond_ = std::make_unique<SequentialPreconditioner>(matrix, std::forward<Args>(args)...);
+    }
+
+    SequentialPreconditioner& get()
+    { return *seqPreCond_; }
+
+    void cleanup()
+    {
+        seqPreCond_.reset();
+        lowPreCond_.reset();
+    }
+
+private:
+    std::unique_ptr<LowMatrix> lowMatrix_;
+    std::unique_ptr<LowPreconditioner> lowPreCond_;
+    std::unique_ptr<SequentialPreconditioner> seqPreCond_;
+};
+
+}} // namespace Linear, Opm
+
+#endif
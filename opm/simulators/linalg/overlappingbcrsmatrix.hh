@@ -263,10 +263,11 @@ public:
     // communicates and adds up the contents of overlapping rows
     void syncAdd()
     {
-        // first, send all entries to the peers
+        // first, post the receives and send all entries to the peers
         const PeerSet& peerSet = overlap_->peerSet();
         typename PeerSet::const_iterator peerIt = peerSet.begin();
         typename PeerSet::const_iterator peerEndIt = peerSet.end();
+        postReceives_();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
 
@@ -294,10 +295,11 @@ public:
     // the master
     void syncCopy()
     {
-        // first, send all entries to the peers
+        // first, post the receives and send all entries to the peers
         const PeerSet& peerSet = overlap_->peerSet();
         typename PeerSet::const_iterator peerIt = peerSet.begin();
         typename PeerSet::const_iterator peerEndIt = peerSet.end();
+        postReceives_();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
 
@@ -578,6 +580,16 @@ private:
 #endif // HAVE_MPI
     }
 
+    // post the receive operations for the entries of all peers. this way, the peers do
+    // not need to buffer the entries which they send to us
+    void postReceives_()
+    {
+#if HAVE_MPI
+        for (const auto peerRank : overlap_->peerSet())
+            entryValuesRecvBuff_[peerRank]->asyncReceive(peerRank);
+#endif // HAVE_MPI
+    }
+
     void sendEntries_([[maybe_unused]] ProcessRank peerRank)
     {
 #if HAVE_MPI
@@ -616,7 +628,7 @@ private:
         auto &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         auto &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
+        mpiRecvBuff.wait();
 
         // retrieve the values from the receive buffer
         unsigned k = 0;
@@ -644,7 +656,7 @@ private:
         MpiBuffer<unsigned> &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         MpiBuffer<Index> &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
+        mpiRecvBuff.wait();
 
         // retrieve the values from the receive buffer
         unsigned k = 0;
@@ -174,11 +174,28 @@ public:
      */
     void sync()
     {
-        // send all entries to all peers
-        for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+        syncBegin();
+        syncEnd();
+    }
+
+    /*!
+     * \brief Start to syncronize the values of the block vector from their master
+     *        process.
+     *
+     * This posts the receive operations and sends the entries which are in the
+     * overlap of the peer processes. Until syncEnd() has been called, the rows which are
+     * not mastered by the local process must not be accessed. The remaining rows can be
+     * modified, but the peers will see their values at the time syncBegin() was
+     * called.
+     */
+    void syncBegin()
+    { startExchange_(); }
 
-        // recieve all entries to the peers
+    /*!
+     * \brief Finish the syncronization started by syncBegin().
+     */
+    void syncEnd()
+    {
         for (const auto peerRank: overlap_->peerSet())
             receiveFromMaster_(peerRank);
 
@@ -192,11 +209,8 @@ public:
      */
     void syncAdd()
     {
-        // send all entries to all peers
-        for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+        startExchange_();
 
-        // recieve all entries to the peers
         for (const auto peerRank: overlap_->peerSet())
             receiveAdd_(peerRank);
 
@@ -291,6 +305,17 @@ private:
 #endif // HAVE_MPI
     }
 
+    void startExchange_()
+    {
+        // post the receives first, so that the peers do not need to buffer the entries
+        // which they send to us
+        for (const auto peerRank: overlap_->peerSet())
+            valuesRecvBuff_[peerRank]->asyncReceive(peerRank);
+
+        for (const auto peerRank: overlap_->peerSet())
+            sendEntries_(peerRank);
+    }
+
     void sendEntries_(ProcessRank peerRank)
     {
         // copy the values into the send buffer
@@ -320,8 +345,8 @@ private:
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
         MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
-        // receive the values from the peer
-        values.receive(peerRank);
+        // wait for the values of the peer
+        values.wait();
 
         // copy them into the block vector
         for (unsigned j = 0; j < indices.size(); ++j) {
@@ -337,8 +362,8 @@ private:
         const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
         MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
 
-        // receive the values from the peer
-        values.receive(peerRank);
+        // wait for the values of the peer
+        values.wait();
 
         // add up the values of rows on the shared boundary
         for (unsigned j = 0; j < indices.size(); ++j) {
@@ -30,17 +30,25 @@
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware linear operator usable by ISTL.
+ *
+ * If the process has peers, the rows of the result which must be sent to them are
+ * computed first. The remaining rows are then computed while the messages are in
+ * flight. Rows which are mastered by a peer are not computed at all because the
+ * synchronization overwrites them with the value of their master.
  */
 template <class OverlappingMatrix, class DomainVector, class RangeVector>
 class OverlappingOperator
     : public Dune::AssembledLinearOperator<OverlappingMatrix, DomainVector, RangeVector>
 {
     using Overlap = typename OverlappingMatrix::Overlap;
+    using RangeBlock = typename RangeVector::block_type;
 
 public:
     //! export types
@@ -48,7 +56,7 @@ public:
     using field_type = typename domain_type::field_type;
 
     OverlappingOperator(const OverlappingMatrix& A) : A_(A)
-    {}
+    { partitionRows_(); }
 
     //! the kind of computations supported by the operator. Either overlapping or non-overlapping
     Dune::SolverCategory::Category category() const override
@@ -57,16 +65,38 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
-        y.sync();
+        if (overlap().peerSet().empty()) {
+            for (unsigned rowIdx : interiorRows_)
+                mvRow_(rowIdx, x, y);
+            y.sync();
+            return;
+        }
+
+        for (unsigned rowIdx : borderRows_)
+            mvRow_(rowIdx, x, y);
+        y.syncBegin();
+        for (unsigned rowIdx : interiorRows_)
+            mvRow_(rowIdx, x, y);
+        y.syncEnd();
     }
 
     //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
-        y.sync();
+        if (overlap().peerSet().empty()) {
+            for (unsigned rowIdx : interiorRows_)
+                usmvRow_(rowIdx, alpha, x, y);
+            y.sync();
+            return;
+        }
+
+        for (unsigned rowIdx : borderRows_)
+            usmvRow_(rowIdx, alpha, x, y);
+        y.syncBegin();
+        for (unsigned rowIdx : interiorRows_)
+            usmvRow_(rowIdx, alpha, x, y);
+        y.syncEnd();
     }
 
     //! returns the matrix
@@ -77,7 +107,52 @@ public:
     { return A_.overlap(); }
 
 private:
+    // split the rows into the ones which are sent to some peer process when the result
+    // vector is synchronized and the ones which are only needed locally. rows which
+    // are mastered by a peer belong to neither group: they are received from the
+    // master and must not be accessed while the messages are in flight.
+    void partitionRows_()
+    {
+        const Overlap& overlap = A_.overlap();
+        std::vector<unsigned char> isBorderRow(A_.N(), 0);
+        for (const auto peerRank : overlap.peerSet()) {
+            const std::size_t numEntries = overlap.foreignOverlapSize(peerRank);
+            for (unsigned i = 0; i < numEntries; ++i)
+                isBorderRow[static_cast<unsigned>(overlap.foreignOverlapOffsetToDomesticIdx(peerRank, i))] = 1;
+        }
+
+        for (unsigned rowIdx = 0; rowIdx < isBorderRow.size(); ++rowIdx) {
+            if (isBorderRow[rowIdx])
+                borderRows_.push_back(rowIdx);
+            else if (overlap.peerSet().empty() || overlap.iAmMasterOf(rowIdx))
+                interiorRows_.push_back(rowIdx);
+        }
+    }
+
+    // the result of a row is accumulated in a local block, so the block kernels of the
+    // matrix (cf. MatrixBlock) can keep it in registers
+    void mvRow_(unsigned rowIdx, const DomainVector& x, RangeVector& y) const
+    {
+        RangeBlock yRow(0.0);
+        const auto& row = A_[rowIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+            colIt->umv(x[colIt.index()], yRow);
+        y[rowIdx] = yRow;
+    }
+
+    void usmvRow_(unsigned rowIdx, field_type alpha, const DomainVector& x, RangeVector& y) const
+    {
+        RangeBlock yRow(0.0);
+        const auto& row = A_[rowIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+            colIt->umv(x[colIt.index()], yRow);
+        yRow *= alpha;
+        y[rowIdx] += yRow;
+    }
+
     const OverlappingMatrix& A_;
+    std::vector<unsigned> borderRows_;
+    std::vector<unsigned> interiorRows_;
 };
 
 } // namespace Linear
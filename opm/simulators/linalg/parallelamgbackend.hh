@@ -32,6 +32,7 @@
 #include "bicgstabsolver.hh"
 #include "combinedcriterion.hh"
 #include "istlsparsematrixadapter.hh"
+#include "mixedprecisionpreconditioner.hh"
 
 #include <dune/istl/bcrsmatrix.hh>
 #include <dune/istl/paamg/amg.hh>
@@ -40,6 +41,7 @@
 
 #include <memory>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace Opm::Linear {
@@ -98,22 +100,31 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
     using ParallelScalarProduct = typename ParentType::ParallelScalarProduct;
 
     static constexpr int numEq = getPropValue<TypeTag, Properties::NumEq>();
-    using VectorBlock = Dune::FieldVector<LinearSolverScalar, numEq>;
     using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
     using IstlMatrix = typename SparseMatrixAdapter::IstlMatrix;
 
+    // the AMG hierarchy is stored using the precision of the preconditioner. if it
+    // differs from the one of the linear solver, the hierarchy is built for a copy of
+    // the matrix.
+    using PreconditionerScalar = GetPropType<TypeTag, Properties::PreconditionerScalar>;
+    static constexpr bool mixedPrecision = !std::is_same<PreconditionerScalar, LinearSolverScalar>::value;
+    using AmgMatrix = std::conditional_t<mixedPrecision,
+                                         Dune::BCRSMatrix<Opm::MatrixBlock<PreconditionerScalar, numEq, numEq>>,
+                                         IstlMatrix>;
+    using VectorBlock = Dune::FieldVector<PreconditionerScalar, numEq>;
+
     using Vector = Dune::BlockVector<VectorBlock>;
 
     // define the smoother used for the AMG and specify its
     // arguments
-    using SequentialSmoother = Dune::SeqSOR<IstlMatrix, Vector, Vector>;
-// using SequentialSmoother = Dune::SeqSSOR<IstlMatrix,Vector,Vector>;
-// using SequentialSmoother = Dune::SeqJac<IstlMatrix,Vector,Vector>;
-// using SequentialSmoother = Dune::SeqILU<IstlMatrix,Vector,Vector>;
+    using SequentialSmoother = Dune::SeqSOR<AmgMatrix, Vector, Vector>;
+// using SequentialSmoother = Dune::SeqSSOR<AmgMatrix,Vector,Vector>;
+// using SequentialSmoother = Dune::SeqJac<AmgMatrix,Vector,Vector>;
+// using SequentialSmoother = Dune::SeqILU<AmgMatrix,Vector,Vector>;
 
 #if HAVE_MPI
     using OwnerOverlapCopyCommunication = Dune::OwnerOverlapCopyCommunication<Opm::Linear::Index>;
-    using FineOperator = Dune::OverlappingSchwarzOperator<IstlMatrix,
+    using FineOperator = Dune::OverlappingSchwarzOperator<AmgMatrix,
                                                           Vector,
                                                           Vector,
                                                           OwnerOverlapCopyCommunication>;
@@ -128,15 +139,19 @@ class ParallelAmgBackend : public ParallelBaseBackend<TypeTag>
                                ParallelSmoother,
                                OwnerOverlapCopyCommunication>;
 #else
-    using FineOperator = Dune::MatrixAdapter<IstlMatrix, Vector, Vector>;
+    using FineOperator = Dune::MatrixAdapter<AmgMatrix, Vector, Vector>;
     using FineScalarProduct = Dune::SeqScalarProduct<Vector>;
     using ParallelSmoother = SequentialSmoother;
     using AMG = Dune::Amg::AMG<FineOperator, Vector, ParallelSmoother>;
 #endif
 
+    using Preconditioner = std::conditional_t<mixedPrecision,
+                                              MixedPrecisionPreconditioner<AMG, OverlappingVector>,
+                                              AMG>;
+
     using RawLinearSolver = BiCGStabSolver<ParallelOperator,
                                            OverlappingVector,
-                                           AMG> ;
+                                           Preconditioner> ;
 
     static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
                   "The ParallelAmgBackend linear solver backend requires the IstlSparseMatrixAdapter");
@@ -161,8 +176,15 @@ public:
 protected:
     friend ParentType;
 
-    std::shared_ptr<AMG> preparePreconditioner_()
+    std::shared_ptr<Preconditioner> preparePreconditioner_()
     {
+        if constexpr (mixedPrecision) {
+            const auto& matrix = *this->overlappingMatrix_;
+            if (!lowPrecisionMatrix_ || !haveSameMatrixPattern(*lowPrecisionMatrix_, matrix))
+                lowPrecisionMatrix_ = copyMatrixPattern<AmgMatrix>(matrix);
+            copyMatrixValues(*lowPrecisionMatrix_, matrix);
+        }
+
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
         // using the domestic overlap
@@ -173,14 +195,38 @@ protected:
 
         // create the parallel scalar product and the parallel operator
 #if HAVE_MPI
-        fineOperator_ = std::make_shared<FineOperator>(*this->overlappingMatrix_, *istlComm_);
+        fineOperator_ = std::make_shared<FineOperator>(amgMatrix_(), *istlComm_);
 #else
-        fineOperator_ = std::make_shared<FineOperator>(*this->overlappingMatrix_);
+        fineOperator_ = std::make_shared<FineOperator>(amgMatrix_());
 #endif
 
         setupAmg_();
 
-        return amg_;
+        if constexpr (mixedPrecision)
+            preconditioner_ = std::make_shared<Preconditioner>(*amg_, this->overlappingMatrix_->N());
+        else
+            preconditioner_ = amg_;
+
+        return preconditioner_;
+    }
+
+    /*!
+     * \brief Reuse the AMG hierarchy for another linear solve.
+     *
+     * If the matrix has changed, only the Galerkin products of the coarse levels are
+     * recomputed while the aggregates of the previous setup are kept. The smoothers
+     * directly operate on the matrices of the hierarchy.
+     */
+    std::shared_ptr<Preconditioner> updatePreconditioner_(bool matrixChanged)
+    {
+        if (matrixChanged) {
+            EWOMS_PROFILE_SCOPE("amg_recalculate_hierarchy");
+            if constexpr (mixedPrecision)
+                copyMatrixValues(*lowPrecisionMatrix_, *this->overlappingMatrix_);
+            amg_->recalculateHierarchy();
+        }
+
+        return preconditioner_;
     }
 
     void cleanupPreconditioner_()
@@ -188,7 +234,7 @@ protected:
 
     std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
                                                     ParallelScalarProduct& parScalarProduct,
-                                                    AMG& parPreCond)
+                                                    Preconditioner& parPreCond)
     {
         const auto& gridView = this->simulator_.gridView();
         using CCC = CombinedCriterion<OverlappingVector, decltype(gridView.comm())>;
@@ -273,10 +319,10 @@ protected:
         // specify the coarsen criterion:
         //
         // using CoarsenCriterion =
-        // Dune::Amg::CoarsenCriterion<Dune::Amg::SymmetricCriterion<IstlMatrix,
+        // Dune::Amg::CoarsenCriterion<Dune::Amg::SymmetricCriterion<AmgMatrix,
         //                             Dune::Amg::FirstDiagonal>>
         using CoarsenCriterion = Dune::Amg::
-            CoarsenCriterion<Dune::Amg::SymmetricCriterion<IstlMatrix, Dune::Amg::FrobeniusNorm> >;
+            CoarsenCriterion<Dune::Amg::SymmetricCriterion<AmgMatrix, Dune::Amg::FrobeniusNorm> >;
         int coarsenTarget = EWOMS_GET_PARAM(TypeTag, int, AmgCoarsenTarget);
         CoarsenCriterion coarsenCriterion(/*maxLevel=*/15, coarsenTarget);
         coarsenCriterion.setDefaultValuesAnisotropic(GridView::dimension,
@@ -300,10 +346,21 @@ protected:
 #endif
     }
 
+    // the matrix for which the AMG hierarchy is built
+    AmgMatrix& amgMatrix_()
+    {
+        if constexpr (mixedPrecision)
+            return *lowPrecisionMatrix_;
+        else
+            return *this->overlappingMatrix_;
+    }
+
     std::unique_ptr<ConvergenceCriterion<OverlappingVector> > convCrit_;
 
+    std::unique_ptr<AmgMatrix> lowPrecisionMatrix_;
     std::shared_ptr<FineOperator> fineOperator_;
     std::shared_ptr<AMG> amg_;
+    std::shared_ptr<Preconditioner> preconditioner_;
 
 #if HAVE_MPI
     std::shared_ptr<OwnerOverlapCopyCommunication> istlComm_;
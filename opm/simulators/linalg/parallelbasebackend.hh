@@ -41,6 +41,9 @@
 #include <opm/models/utils/genericguard.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/profiler.hh>
+#include <opm/models/utils/timer.hh>
+#include <opm/models/utils/timerguard.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 
@@ -49,6 +52,7 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <algorithm>
 #include <sstream>
 #include <memory>
 #include <iostream>
@@ -103,6 +107,15 @@ namespace Linear {
  *            that it is computationally cheaper because it does not
  *            need to consider things which are only required for
  *            higher orders
+ *
+ * By default, the preconditioner is set up from scratch whenever the matrix has been
+ * changed by setMatrix(). A preconditioner which was set up for the current matrix is
+ * always used again, e.g., if the Newton method keeps the Jacobian of the previous
+ * iteration. If the PreconditionerReuse parameter is enabled, the preconditioner is
+ * also kept if the matrix changes, across linear solves and time steps, and it is only
+ * rebuilt if the number of linear iterations degrades. Implementations
+ * can refresh the numerics of a reused preconditioner whose matrix has changed by
+ * overloading updatePreconditioner_().
  */
 template <class TypeTag>
 class ParallelBaseBackend
@@ -142,10 +155,18 @@ public:
         overlappingMatrix_ = nullptr;
         overlappingb_ = nullptr;
         overlappingx_ = nullptr;
+
+        enablePreconditionerReuse_ = EWOMS_GET_PARAM(TypeTag, bool, PreconditionerReuse);
+        preconditionerRebuildIterationFactor_ =
+            EWOMS_GET_PARAM(TypeTag, Scalar, PreconditionerRebuildIterationFactor);
     }
 
     ~ParallelBaseBackend()
-    { cleanup_(); }
+    {
+        parPreCond_.reset();
+        precWrapper_.cleanup();
+        cleanup_();
+    }
 
     /*!
      * \brief Register all run-time parameters for the linear solver.
@@ -162,6 +183,12 @@ public:
                              "The maximum number of iterations of the linear solver");
         EWOMS_REGISTER_PARAM(TypeTag, int, LinearSolverVerbosity,
                              "The verbosity level of the linear solver");
+        EWOMS_REGISTER_PARAM(TypeTag, bool, PreconditionerReuse,
+                             "Keep the preconditioner across linear solves until the "
+                             "number of linear iterations degrades");
+        EWOMS_REGISTER_PARAM(TypeTag, Scalar, PreconditionerRebuildIterationFactor,
+                             "The factor by which the number of linear iterations may "
+                             "grow before a reused preconditioner is rebuilt");
 
         PreconditionerWrapper::registerParameters();
     }
@@ -171,7 +198,10 @@ public:
      *        equations the next time it is called.
      */
     void eraseMatrix()
-    { cleanup_(); }
+    {
+        releasePreconditioner_();
+        cleanup_();
+    }
 
     /*!
      * \brief Set up the internal data structures required for the linear solver.
@@ -188,6 +218,8 @@ public:
             // there's noting to do
             return;
 
+        // the preconditioner refers to the old overlapping matrix
+        releasePreconditioner_();
         asImp_().cleanup_();
         gridSequenceNumber_ = curSeqNum;
 
@@ -242,6 +274,7 @@ public:
     {
         overlappingMatrix_->assignFromNative(M.istlMatrix());
         overlappingMatrix_->syncAdd();
+        matrixChanged_ = true;
     }
 
     /*!
@@ -253,10 +286,11 @@ public:
     {
         (*overlappingx_) = 0.0;
 
-        auto parPreCond = asImp_().preparePreconditioner_();
-        auto precondCleanupFn = [this]() -> void
-                                { this->asImp_().cleanupPreconditioner_(); };
-        auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
+        // the preconditioner is kept after the solve, so it can be used again as long
+        // as the matrix does not change. setupPreconditioner_() releases it before a new
+        // one is set up.
+        auto parPreCond = setupPreconditioner_();
+
         // create the parallel scalar product and the parallel operator
         ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
         ParallelOperator parOperator(*overlappingMatrix_);
@@ -272,9 +306,28 @@ public:
         GenericGuard<decltype(cleanupSolverFn)> solverGuard(cleanupSolverFn);
 
         // run the linear solver and have some fun
-        auto result = asImp_().runSolver_(solver);
+        std::pair<bool, int> result;
+        {
+            EWOMS_PROFILE_SCOPE("linear_solver_apply");
+            TimerGuard applyTimerGuard(solverApplyTimer_);
+            solverApplyTimer_.start();
+            result = asImp_().runSolver_(solver);
+        }
         // store number of iterations used
         lastIterations_ = result.second;
+        EWOMS_PROFILE_COUNT("linear_iterations", lastIterations_);
+
+        // the first solve after setting up the preconditioner defines the number of
+        // iterations which can be expected from it.
+        if (enablePreconditionerReuse_) {
+            if (referenceIterations_ == 0)
+                referenceIterations_ = std::max<size_t>(lastIterations_, 1);
+            else if (lastIterations_ > preconditionerRebuildIterationFactor_*referenceIterations_)
+                rebuildPreconditioner_ = true;
+
+            if (!result.first)
+                rebuildPreconditioner_ = true;
+        }
 
         // copy the result back to the non-overlapping vector
         overlappingx_->assignTo(x);
@@ -289,6 +342,26 @@ public:
     size_t iterations () const
     { return lastIterations_; }
 
+    /*!
+     * \brief Returns the number of times the preconditioner was set up from scratch.
+     */
+    unsigned numPreconditionerSetups() const
+    { return numPreconditionerSetups_; }
+
+    /*!
+     * \brief Returns the timer for setting up, refreshing or reusing the
+     *        preconditioner.
+     */
+    const Timer& preconditionerSetupTimer() const
+    { return preconditionerSetupTimer_; }
+
+    /*!
+     * \brief Returns the timer for running the Krylov solver, including the
+     *        applications of the preconditioner.
+     */
+    const Timer& solverApplyTimer() const
+    { return solverApplyTimer_; }
+
 protected:
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -329,14 +402,64 @@ protected:
             throw NumericalProblem("Creating the preconditioner failed");
 
         // create the parallel preconditioner
-        return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+        parPreCond_ = std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+        return parPreCond_;
     }
 
+    /*!
+     * \brief Returns a preconditioner which is reused for another linear solve.
+     *
+     * The sequential preconditioners of dune-istl do not separate their symbolic and
+     * numeric setup, so the previous preconditioner is used as is even if the matrix
+     * has changed.
+     */
+    std::shared_ptr<ParallelPreconditioner> updatePreconditioner_(bool /*matrixChanged*/)
+    { return parPreCond_; }
+
     void cleanupPreconditioner_()
     {
+        parPreCond_.reset();
         precWrapper_.cleanup();
     }
 
+    // returns the preconditioner for the next linear solve. it is set up from scratch
+    // unless it was set up for the current matrix or the reuse policy allows to keep
+    // the previous one.
+    auto setupPreconditioner_()
+    {
+        EWOMS_PROFILE_SCOPE("preconditioner_setup");
+        TimerGuard setupTimerGuard(preconditionerSetupTimer_);
+        preconditionerSetupTimer_.start();
+        const bool isUpToDate = preconditionerIsReady_ && !matrixChanged_;
+        if (!isUpToDate
+            && (!enablePreconditionerReuse_ || !preconditionerIsReady_ || rebuildPreconditioner_))
+        {
+            releasePreconditioner_();
+            auto parPreCond = asImp_().preparePreconditioner_();
+            preconditionerIsReady_ = true;
+            rebuildPreconditioner_ = false;
+            matrixChanged_ = false;
+            referenceIterations_ = 0;
+            ++numPreconditionerSetups_;
+            EWOMS_PROFILE_COUNT("preconditioner_setups", 1);
+            return parPreCond;
+        }
+
+        EWOMS_PROFILE_COUNT("preconditioner_reuses", 1);
+        const bool matrixChanged = matrixChanged_;
+        matrixChanged_ = false;
+        return asImp_().updatePreconditioner_(matrixChanged);
+    }
+
+    void releasePreconditioner_()
+    {
+        if (!preconditionerIsReady_)
+            return;
+
+        asImp_().cleanupPreconditioner_();
+        preconditionerIsReady_ = false;
+    }
+
     void writeOverlapToVTK_()
     {
         for (int lookedAtRank = 0;
@@ -383,6 +506,19 @@ protected:
     OverlappingVector *overlappingx_;
 
     PreconditionerWrapper precWrapper_;
+    std::shared_ptr<ParallelPreconditioner> parPreCond_;
+
+    // state of the preconditioner reuse policy
+    bool enablePreconditionerReuse_;
+    Scalar preconditionerRebuildIterationFactor_;
+    bool preconditionerIsReady_ = false;
+    bool rebuildPreconditioner_ = false;
+    bool matrixChanged_ = false;
+    size_t referenceIterations_ = 0;
+    unsigned numPreconditionerSetups_ = 0;
+
+    Timer preconditionerSetupTimer_;
+    Timer solverApplyTimer_;
 };
 }} // namespace Linear, Opm
 
@@ -400,6 +536,18 @@ struct PreconditionerRelaxation<TypeTag, TTag::ParallelBaseLinearSolver>
     static constexpr type value = 1.0;
 };
 
+//! set up the preconditioner for every linear solve by default
+template<class TypeTag>
+struct PreconditionerReuse<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr bool value = false; };
+
+//! rebuild a reused preconditioner if the number of linear iterations doubled
+template<class TypeTag>
+struct PreconditionerRebuildIterationFactor<TypeTag, TTag::ParallelBaseLinearSolver>
+{
+    using type = GetPropType<TypeTag, Scalar>;
+    static constexpr type value = 2.0;
+};
+
 //! set the preconditioner order to 0 by default
 template<class TypeTag>
 struct PreconditionerOrder<TypeTag, TTag::ParallelBaseLinearSolver> { static constexpr int value = 0; };
@@ -410,6 +558,11 @@ template<class TypeTag>
 struct LinearSolverScalar<TypeTag, TTag::ParallelBaseLinearSolver>
 { using type = GetPropType<TypeTag, Properties::Scalar>; };
 
+//! by default the preconditioner is stored using the precision of the linear solver
+template<class TypeTag>
+struct PreconditionerScalar<TypeTag, TTag::ParallelBaseLinearSolver>
+{ using type = GetPropType<TypeTag, Properties::LinearSolverScalar>; };
+
 template<class TypeTag>
 struct OverlappingMatrix<TypeTag, TTag::ParallelBaseLinearSolver>
 {
@@ -0,0 +1,322 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Tests the fluxes of the TPFA local residual of the black-oil model with the
+ *        energy extension enabled.
+ *
+ * The intensive quantities of the two cells of a face are specified directly, so this
+ * test does not need a grid or a deck.
+ */
+#include "config.h"
+
+#include <opm/models/blackoil/blackoilmodel.hh>
+#include <opm/models/blackoil/blackoillocalresidualtpfa.hh>
+#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
+
+#include <opm/material/fluidstates/BlackOilFluidState.hpp>
+#include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
+
+#include "problems/reservoirproblem.hh"
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace Opm {
+
+// The intensive quantities of a cell which are required by the fluxes of the TPFA
+// local residual if energy is conserved.
+template <class TypeTag>
+class TpfaTestIntensiveQuantities
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+
+    enum { numPhases = FluidSystem::numPhases };
+
+public:
+    using FluidState = BlackOilFluidState<Evaluation,
+                                          FluidSystem,
+                                          /*enableTemperature=*/false,
+                                          /*enableEnergy=*/true,
+                                          /*enableDissolution=*/Indices::compositionSwitchIdx >= 0,
+                                          /*enableEvaporation=*/false,
+                                          /*enableBrine=*/false,
+                                          /*enableSaltPrecipitation=*/false,
+                                          /*enableDissolutionInWater=*/false,
+                                          Indices::numPhases>;
+
+    FluidState& fluidState()
+    { return fluidState_; }
+
+    const FluidState& fluidState() const
+    { return fluidState_; }
+
+    const Evaluation& mobility(unsigned phaseIdx) const
+    { return mobility_[phaseIdx]; }
+
+    const Evaluation& mobility(unsigned phaseIdx, FaceDir::DirEnum) const
+    { return mobility_[phaseIdx]; }
+
+    void setMobility(unsigned phaseIdx, const Evaluation& value)
+    { mobility_[phaseIdx] = value; }
+
+    const Evaluation& rockCompTransMultiplier() const
+    { return rockCompTransMultiplier_; }
+
+    const Evaluation& porosity() const
+    { return porosity_; }
+
+    unsigned pvtRegionIndex() const
+    { return 0; }
+
+    const Evaluation& totalThermalConductivity() const
+    { return totalThermalConductivity_; }
+
+    void setTotalThermalConductivity(const Evaluation& value)
+    { totalThermalConductivity_ = value; }
+
+private:
+    FluidState fluidState_;
+    Evaluation mobility_[numPhases];
+    Evaluation rockCompTransMultiplier_ = 1.0;
+    Evaluation porosity_ = 0.2;
+    Evaluation totalThermalConductivity_ = 0.0;
+};
+
+// The TPFA local residual only requires the static method which determines the
+// upstream cell of a phase from the extensive quantities. It is provided by the flux
+// module of the simulator, so the rules of the local residual itself are used here.
+template <class TypeTag>
+class TpfaTestExtensiveQuantities
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using Toolbox = MathToolbox<Evaluation>;
+
+public:
+    static void calculatePhasePressureDiff_(short& upIdx,
+                                            short& dnIdx,
+                                            Evaluation& pressureDifference,
+                                            const IntensiveQuantities& intQuantsIn,
+                                            const IntensiveQuantities& intQuantsEx,
+                                            unsigned phaseIdx,
+                                            short interiorDofIdx,
+                                            short exteriorDofIdx,
+                                            Scalar Vin,
+                                            Scalar Vex,
+                                            unsigned globalIndexIn,
+                                            unsigned globalIndexEx,
+                                            Scalar distZg,
+                                            Scalar thpres)
+    {
+        const auto& fsIn = intQuantsIn.fluidState();
+        const auto& fsEx = intQuantsEx.fluidState();
+        unsigned globalUpIndex;
+        BlackOilLocalResidualTPFA<TypeTag>::calculatePhasePressureDiff_(globalUpIndex,
+                                                                        pressureDifference,
+                                                                        fsIn.density(phaseIdx),
+                                                                        Toolbox::value(fsEx.density(phaseIdx)),
+                                                                        fsIn.pressure(phaseIdx),
+                                                                        Toolbox::value(fsEx.pressure(phaseIdx)),
+                                                                        Vin,
+                                                                        Vex,
+                                                                        globalIndexIn,
+                                                                        globalIndexEx,
+                                                                        distZg,
+                                                                        thpres);
+        upIdx = (globalUpIndex == globalIndexIn) ? interiorDofIdx : exteriorDofIdx;
+        dnIdx = (globalUpIndex == globalIndexIn) ? exteriorDofIdx : interiorDofIdx;
+    }
+};
+
+} // namespace Opm
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct TpfaEnergyTestProblem
+{ using InheritsFrom = std::tuple<ReservoirBaseProblem, BlackOilModel>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct SpatialDiscretizationSplice<TypeTag, TTag::TpfaEnergyTestProblem>
+{ using type = TTag::EcfvDiscretization; };
+
+template<class TypeTag>
+struct EnableEnergy<TypeTag, TTag::TpfaEnergyTestProblem>
+{ static constexpr bool value = true; };
+
+template<class TypeTag>
+struct IntensiveQuantities<TypeTag, TTag::TpfaEnergyTestProblem>
+{ using type = TpfaTestIntensiveQuantities<TypeTag>; };
+
+template<class TypeTag>
+struct ExtensiveQuantities<TypeTag, TTag::TpfaEnergyTestProblem>
+{ using type = TpfaTestExtensiveQuantities<TypeTag>; };
+
+} // namespace Opm::Properties
+
+using TypeTag = Opm::Properties::TTag::TpfaEnergyTestProblem;
+using Scalar = Opm::GetPropType<TypeTag, Opm::Properties::Scalar>;
+using Evaluation = Opm::GetPropType<TypeTag, Opm::Properties::Evaluation>;
+using FluidSystem = Opm::GetPropType<TypeTag, Opm::Properties::FluidSystem>;
+using Indices = Opm::GetPropType<TypeTag, Opm::Properties::Indices>;
+using RateVector = Opm::GetPropType<TypeTag, Opm::Properties::RateVector>;
+using IntensiveQuantities = Opm::GetPropType<TypeTag, Opm::Properties::IntensiveQuantities>;
+using LocalResidual = Opm::BlackOilLocalResidualTPFA<TypeTag>;
+using ResidualNBInfo = typename LocalResidual::ResidualNBInfo;
+
+constexpr unsigned numEq = Opm::getPropValue<TypeTag, Opm::Properties::NumEq>();
+
+void checkClose(Scalar value, Scalar reference, const std::string& what)
+{
+    if (std::abs(value - reference) > 1e-10*(1.0 + std::abs(reference)))
+        throw std::logic_error("Unexpected "+what+": "+std::to_string(value)
+                               +" instead of "+std::to_string(reference));
+}
+
+// only the quantities of the interior cell carry derivatives
+IntensiveQuantities createIntensiveQuantities(Scalar pressure,
+                                              Scalar temperature,
+                                              Scalar thermalConductivity,
+                                              bool isInterior)
+{
+    const auto eval = [isInterior](Scalar value, int varIdx) -> Evaluation
+    { return isInterior ? Evaluation::createVariable(value, varIdx) : Evaluation(value); };
+
+    IntensiveQuantities intQuants;
+    auto& fs = intQuants.fluidState();
+    fs.setPvtRegionIndex(0);
+    fs.setTemperature(eval(temperature, Indices::temperatureIdx));
+    for (unsigned phaseIdx = 0; phaseIdx < FluidSystem::numPhases; ++phaseIdx) {
+        fs.setPressure(phaseIdx, eval(pressure + 1e4*phaseIdx, Indices::pressureSwitchIdx));
+        fs.setSaturation(phaseIdx, 1.0/FluidSystem::numPhases);
+        fs.setDensity(phaseIdx, 500.0 + 100.0*phaseIdx);
+        fs.setInvB(phaseIdx, 1.0 - 0.1*phaseIdx);
+        fs.setEnthalpy(phaseIdx, 4.0e3*temperature);
+        intQuants.setMobility(phaseIdx, 1e3*(phaseIdx + 1));
+    }
+    intQuants.setTotalThermalConductivity(thermalConductivity);
+
+    return intQuants;
+}
+
+ResidualNBInfo createNBInfo(Scalar dZg, Scalar Vin, Scalar Vex, Scalar inAlpha, Scalar outAlpha)
+{
+    return ResidualNBInfo{/*trans=*/1e-12,
+                          /*faceArea=*/2.0,
+                          /*thpres=*/0.0,
+                          dZg,
+                          Vin,
+                          Vex,
+                          Opm::FaceDir::DirEnum::XPlus,
+                          /*dist=*/1.0,
+                          inAlpha,
+                          outAlpha,
+                          /*diffusivity=*/0.0,
+                          /*Swcr=*/0.0};
+}
+
+// without a pressure difference, the energy flux is the heat conduction between the
+// cells
+void testHeatConduction()
+{
+    const Scalar lambdaIn = 2.0;
+    const Scalar lambdaEx = 3.0;
+    const Scalar alphaIn = 5.0;
+    const Scalar alphaEx = 7.0;
+    const Scalar TIn = 350.0;
+    const Scalar TEx = 300.0;
+
+    const auto intQuantsIn = createIntensiveQuantities(1e7, TIn, lambdaIn, /*isInterior=*/true);
+    const auto intQuantsEx = createIntensiveQuantities(1e7, TEx, lambdaEx, /*isInterior=*/false);
+    const auto nbInfo = createNBInfo(/*dZg=*/0.0, /*Vin=*/1.0, /*Vex=*/1.0, alphaIn, alphaEx);
+
+    RateVector flux;
+    RateVector darcy;
+    LocalResidual::computeFlux(flux, darcy, 0, 1, intQuantsIn, intQuantsEx, nbInfo);
+
+    const Scalar H = 1.0/(1.0/(lambdaIn*alphaIn) + 1.0/(lambdaEx*alphaEx));
+    const Scalar scaling = Opm::getPropValue<TypeTag, Opm::Properties::BlackOilEnergyScalingFactor>();
+    const auto& energyFlux = flux[Indices::contiEnergyEqIdx];
+    checkClose(energyFlux.value(), (TIn - TEx)*H/nbInfo.faceArea*scaling, "heat conduction");
+    checkClose(energyFlux.derivative(Indices::temperatureIdx), H/nbInfo.faceArea*scaling,
+               "derivative of the heat conduction");
+
+    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+        if (eqIdx != Indices::contiEnergyEqIdx)
+            checkClose(flux[eqIdx].value(), 0.0, "mass flux without a pressure difference");
+    }
+}
+
+// the flux over a face must be the same if it is seen from the other side, and the
+// flux without derivatives must match the one with derivatives
+void testFluxSymmetry()
+{
+    const auto intQuantsI = createIntensiveQuantities(2e7, 350.0, 2.0, /*isInterior=*/true);
+    const auto intQuantsJ = createIntensiveQuantities(1e7, 300.0, 3.0, /*isInterior=*/true);
+    const auto nbInfoIJ = createNBInfo(/*dZg=*/9.81, /*Vin=*/1.0, /*Vex=*/2.0, 5.0, 7.0);
+    const auto nbInfoJI = createNBInfo(/*dZg=*/-9.81, /*Vin=*/2.0, /*Vex=*/1.0, 7.0, 5.0);
+
+    RateVector fluxIJ;
+    RateVector fluxJI;
+    RateVector darcy;
+    LocalResidual::computeFlux(fluxIJ, darcy, 0, 1, intQuantsI, intQuantsJ, nbInfoIJ);
+    LocalResidual::computeFlux(fluxJI, darcy, 1, 0, intQuantsJ, intQuantsI, nbInfoJI);
+
+    Dune::FieldVector<Scalar, numEq> fluxValues;
+    Dune::FieldVector<Scalar, numEq> darcyValues;
+    LocalResidual::computeFluxValues(fluxValues, darcyValues, 0, 1, intQuantsI, intQuantsJ, nbInfoIJ);
+
+    if (fluxIJ[Indices::contiEnergyEqIdx].value() <= 0.0)
+        throw std::logic_error("Energy does not flow out of the hotter cell with the higher pressure");
+
+    for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+        const std::string eqName = "flux of equation "+std::to_string(eqIdx);
+        checkClose(fluxIJ[eqIdx].value(), -fluxJI[eqIdx].value(), eqName+" from the other side");
+        checkClose(fluxValues[eqIdx], fluxIJ[eqIdx].value(), eqName+" without derivatives");
+    }
+}
+
+int main()
+{
+    FluidSystem::initBegin(/*numPvtRegions=*/1);
+    FluidSystem::setEnableDissolvedGas(false);
+    FluidSystem::setEnableVaporizedOil(false);
+    FluidSystem::setReferenceDensities(/*rhoOil=*/800.0, /*rhoWater=*/1000.0, /*rhoGas=*/1.0, /*regionIdx=*/0);
+    FluidSystem::initEnd();
+
+    testHeatConduction();
+    testFluxSymmetry();
+
+    std::cout << "All tests passed\n";
+
+    return 0;
+}
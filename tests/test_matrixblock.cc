@@ -0,0 +1,174 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Compares the fixed-size kernels of MatrixBlock with the generic ones of
+ *        dune-common.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <dune/common/fvector.hh>
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+std::mt19937 randomGenerator(42);
+
+template <class Vector>
+void fillRandom(Vector& v)
+{
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (std::size_t i = 0; i < v.size(); ++i)
+        v[i] = dist(randomGenerator);
+}
+
+// the diagonal is made dominant, so the block can be inverted safely
+template <class Block>
+void fillRandomBlock(Block& A)
+{
+    for (std::size_t i = 0; i < A.N(); ++i) {
+        fillRandom(A[i]);
+        if (i < A.M())
+            A[i][i] += 2.0*A.M();
+    }
+}
+
+template <class VectorA, class VectorB>
+void checkEqual(const VectorA& a, const VectorB& b, const std::string& what, int n)
+{
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (std::abs(a[i] - b[i]) > 1e-12*(1.0 + std::abs(b[i])))
+            throw std::logic_error("The result of "+what+" for blocks of size "
+                                   +std::to_string(n)+" deviates from the one of "
+                                   "dune-common at index "+std::to_string(i)+": "
+                                   +std::to_string(a[i])+" instead of "+std::to_string(b[i]));
+    }
+}
+
+template <int n>
+void testBlockSize()
+{
+    using Block = Opm::MatrixBlock<double, n, n>;
+    using Vector = Dune::FieldVector<double, n>;
+
+    Block A;
+    fillRandomBlock(A);
+    const auto& baseA = A.asBase();
+
+    Vector x;
+    fillRandom(x);
+    const double alpha = 0.75;
+
+    // y = A x
+    Vector y;
+    Vector yRef;
+    A.mv(x, y);
+    baseA.mv(x, yRef);
+    checkEqual(y, yRef, "mv()", n);
+
+    // y += A x
+    fillRandom(y);
+    yRef = y;
+    A.umv(x, y);
+    baseA.umv(x, yRef);
+    checkEqual(y, yRef, "umv()", n);
+
+    // y -= A x
+    fillRandom(y);
+    yRef = y;
+    A.mmv(x, y);
+    baseA.mmv(x, yRef);
+    checkEqual(y, yRef, "mmv()", n);
+
+    // y += alpha A x
+    fillRandom(y);
+    yRef = y;
+    A.usmv(alpha, x, y);
+    baseA.usmv(alpha, x, yRef);
+    checkEqual(y, yRef, "usmv()", n);
+
+    // A = A B
+    Block B;
+    fillRandomBlock(B);
+    Block AB(A);
+    auto ABRef = A.asBase();
+    AB.rightmultiply(B);
+    ABRef.rightmultiply(B.asBase());
+    for (int i = 0; i < n; ++i)
+        checkEqual(AB[i], ABRef[i], "rightmultiply()", n);
+
+    // A x = b
+    Vector b;
+    fillRandom(b);
+    Vector xRef;
+    A.solve(x, b);
+    baseA.solve(xRef, b);
+    checkEqual(x, xRef, "solve()", n);
+
+    // the kernels must give the same result if the block has to be pivoted
+    Block P(0.0);
+    for (int i = 0; i < n; ++i)
+        P[i][(i + 1) % n] = 1.0 + i;
+    P.solve(x, b);
+    P.asBase().solve(xRef, b);
+    checkEqual(x, xRef, "solve() with pivoting", n);
+
+    // singular blocks are reported via an exception. (dune-common only checks this if
+    // DUNE_FMatrix_WITH_CHECKING is defined.)
+    if constexpr (Opm::detail::useBlockKernels<n, n>) {
+        bool caughtException = false;
+        try {
+            Block S(0.0);
+            S.solve(x, b);
+        }
+        catch (const Opm::NumericalProblem&) {
+            caughtException = true;
+        }
+        if (!caughtException)
+            throw std::logic_error("Solving with a singular block of size "+std::to_string(n)
+                                   +" did not throw");
+    }
+}
+
+int main()
+{
+    // blocks of size 1 and 7 are handled by dune-common and serve as a sanity check
+    testBlockSize<1>();
+    testBlockSize<2>();
+    testBlockSize<3>();
+    testBlockSize<4>();
+    testBlockSize<5>();
+    testBlockSize<6>();
+    testBlockSize<7>();
+
+    std::cout << "All tests passed\n";
+
+    return 0;
+}
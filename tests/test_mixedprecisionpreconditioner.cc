@@ -0,0 +1,149 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief A test for the preconditioners which are stored in a lower floating point
+ *        precision than the linear solver.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/mixedprecisionpreconditioner.hh>
+
+#include <dune/istl/preconditioners.hh>
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+static constexpr int numEq = 2;
+using Block = Opm::MatrixBlock<double, numEq, numEq>;
+using Matrix = Dune::BCRSMatrix<Block>;
+using Vector = Dune::BlockVector<Dune::FieldVector<double, numEq>>;
+
+template <class M, class X, class Y>
+using GaussSeidel = Dune::SeqGS<M, X, Y>;
+
+using Factory = Opm::Linear::MixedPrecisionPreconditionerFactory<Matrix, Vector, float, GaussSeidel>;
+
+// function prototypes
+Matrix createMatrix(std::size_t numRows, std::size_t offset);
+void testApply(Factory& factory, Matrix& matrix);
+
+// create a diagonally dominant matrix where row i features the columns i and
+// (i + offset) modulo the number of rows. all offsets result in the same number of
+// non-zero entries.
+Matrix createMatrix(std::size_t numRows, std::size_t offset)
+{
+    Matrix matrix(numRows, numRows, Matrix::random);
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        matrix.setrowsize(rowIdx, 2);
+    matrix.endrowsizes();
+
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        matrix.addindex(rowIdx, rowIdx);
+        matrix.addindex(rowIdx, (rowIdx + offset) % numRows);
+    }
+    matrix.endindices();
+
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        for (auto colIt = matrix[rowIdx].begin(); colIt != matrix[rowIdx].end(); ++colIt) {
+            for (int i = 0; i < numEq; ++i) {
+                for (int j = 0; j < numEq; ++j) {
+                    if (colIt.index() == rowIdx)
+                        (*colIt)[i][j] = (i == j) ? 10.0 + rowIdx : 1.0;
+                    else
+                        (*colIt)[i][j] = -1.0 - 0.5*i - 0.25*j;
+                }
+            }
+        }
+    }
+
+    return matrix;
+}
+
+// apply the mixed precision preconditioner and the one which uses double precision
+// and make sure that the results agree up to the precision of float
+void testApply(Factory& factory, Matrix& matrix)
+{
+    factory.prepare(matrix, /*numIterations=*/1, /*relaxationFactor=*/1.0);
+    GaussSeidel<Matrix, Vector, Vector> referencePreconditioner(matrix, 1, 1.0);
+
+    Vector d(matrix.N());
+    for (std::size_t i = 0; i < d.size(); ++i)
+        for (int k = 0; k < numEq; ++k)
+            d[i][k] = 1.0 + i + 0.5*k;
+
+    Vector v(matrix.N());
+    Vector vReference(matrix.N());
+    v = 0.0;
+    vReference = 0.0;
+    factory.get().apply(v, d);
+    referencePreconditioner.apply(vReference, d);
+
+    for (std::size_t i = 0; i < v.size(); ++i) {
+        for (int k = 0; k < numEq; ++k) {
+            if (std::abs(v[i][k] - vReference[i][k]) > 1e-5*(1.0 + std::abs(vReference[i][k])))
+                throw std::logic_error("The mixed precision preconditioner yields "
+                                       + std::to_string(v[i][k]) + " instead of "
+                                       + std::to_string(vReference[i][k])
+                                       + " for row " + std::to_string(i));
+        }
+    }
+}
+
+int main()
+{
+    const std::size_t numRows = 10;
+    Matrix matrixA = createMatrix(numRows, /*offset=*/1);
+    Matrix matrixB = createMatrix(numRows, /*offset=*/numRows - 1);
+
+    auto lowMatrix = Opm::Linear::copyMatrixPattern<Factory::LowMatrix>(matrixA);
+    if (!Opm::Linear::haveSameMatrixPattern(*lowMatrix, matrixA))
+        throw std::logic_error("The copy of a matrix pattern must be identical to the original");
+    if (Opm::Linear::haveSameMatrixPattern(*lowMatrix, matrixB))
+        throw std::logic_error("Matrices with different column indices must not have the same pattern");
+
+    Opm::Linear::copyMatrixValues(*lowMatrix, matrixA);
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        auto lowColIt = (*lowMatrix)[rowIdx].begin();
+        for (auto colIt = matrixA[rowIdx].begin(); colIt != matrixA[rowIdx].end(); ++colIt, ++lowColIt)
+            for (int i = 0; i < numEq; ++i)
+                for (int j = 0; j < numEq; ++j)
+                    if ((*lowColIt)[i][j] != static_cast<float>((*colIt)[i][j]))
+                        throw std::logic_error("The values of the matrix were not copied correctly");
+    }
+
+    // the same factory is used for both matrices, so the low precision copy must be
+    // recreated although the number of rows and non-zero entries is the same
+    Factory factory;
+    testApply(factory, matrixA);
+    testApply(factory, matrixB);
+    testApply(factory, matrixA);
+
+    std::cout << "All tests passed\n";
+
+    return 0;
+}
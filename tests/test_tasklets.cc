@@ -24,14 +24,19 @@
  * \file
  *
  * \brief This file serves as an example of how to use the tasklet mechanism for
- *        asynchronous work.
+ *        asynchronous work. It also measures the throughput and the latency of the
+ *        tasklet runner.
  */
 #include "config.h"
 
 #include <opm/models/parallel/tasklets.hh>
 
+#include <atomic>
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <mutex>
+#include <vector>
 
 std::mutex outputMutex;
 
@@ -74,6 +79,66 @@ void sleepAndPrintFunction()
 
 int SleepTasklet::numInstantiated_ = 0;
 
+std::atomic<long> numTinyRuns(0);
+
+// a tasklet which does almost nothing, used to measure the overhead of the runner
+class TinyTasklet : public Opm::TaskletInterface
+{
+public:
+    TinyTasklet(int numInvocations = 1)
+        : Opm::TaskletInterface(numInvocations)
+    {}
+
+    void run()
+    { ++ numTinyRuns; }
+};
+
+// measure how many tiny tasklets per second the runner can process
+void benchmarkThroughput(int numWorkers, long numTasklets)
+{
+    Opm::TaskletRunner benchRunner(numWorkers);
+    numTinyRuns = 0;
+
+    auto startTime = std::chrono::steady_clock::now();
+    for (long i = 0; i < numTasklets; ++i)
+        benchRunner.dispatch(std::make_shared<TinyTasklet>());
+    benchRunner.barrier();
+    auto endTime = std::chrono::steady_clock::now();
+
+    if (numTinyRuns != numTasklets)
+        throw std::logic_error("Not all tasklets were run: "+std::to_string(numTinyRuns)
+                               +" instead of "+std::to_string(numTasklets));
+
+    double seconds = std::chrono::duration<double>(endTime - startTime).count();
+    std::cout << "Throughput with " << numWorkers << " worker thread(s): "
+              << numTasklets/seconds << " tasklets/s\n";
+}
+
+// measure the time between the dispatch of a tasklet and the return of the
+// subsequent barrier
+void benchmarkLatency(int numWorkers, int numSamples)
+{
+    Opm::TaskletRunner benchRunner(numWorkers);
+    numTinyRuns = 0;
+
+    std::vector<double> samples;
+    for (int i = 0; i < numSamples; ++i) {
+        auto startTime = std::chrono::steady_clock::now();
+        benchRunner.dispatch(std::make_shared<TinyTasklet>());
+        benchRunner.barrier();
+        auto endTime = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(endTime - startTime).count());
+    }
+
+    if (numTinyRuns != numSamples)
+        throw std::logic_error("Not all tasklets were run");
+
+    std::sort(samples.begin(), samples.end());
+    std::cout << "Round trip latency with " << numWorkers << " worker thread(s): "
+              << "median " << samples[samples.size()/2] << " us, "
+              << "99th percentile " << samples[(samples.size()*99)/100] << " us\n";
+}
+
 int main()
 {
     int numWorkers = 2;
@@ -98,6 +163,35 @@ int main()
 
     delete runner;
 
+    // tasklets which are invoked multiple times must be run exactly that often, even if
+    // the number of invocations exceeds the capacity of the queues
+    {
+        Opm::TaskletRunner multiRunner(numWorkers);
+        numTinyRuns = 0;
+        multiRunner.dispatch(std::make_shared<TinyTasklet>(/*numInvocations=*/5000));
+        multiRunner.barrier();
+        if (numTinyRuns != 5000)
+            throw std::logic_error("Multi-invocation tasklet was not run the requested number of times");
+    }
+
+    // the memory of the tasklets created by dispatchFunction() is recycled, so many of
+    // them must be able to be in flight and reused concurrently
+    {
+        Opm::TaskletRunner fnRunner(numWorkers);
+        numTinyRuns = 0;
+        auto tinyFunction = []() { ++ numTinyRuns; };
+        for (int i = 0; i < 10000; ++i)
+            fnRunner.dispatchFunction(tinyFunction, /*numInvocations=*/2);
+        fnRunner.barrier();
+        if (numTinyRuns != 20000)
+            throw std::logic_error("Not all function runner tasklets were run");
+    }
+
+    for (int n : {0, 1, 2, 4}) {
+        benchmarkThroughput(n, /*numTasklets=*/200000);
+        benchmarkLatency(n, /*numSamples=*/1000);
+    }
+
     return 0;
 }
 